@@ -0,0 +1,288 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+
+#if defined(__APPLE__)
+    #include <Glut/glut.h>
+#elif defined(_WIN32) || defined(_WIN64)
+    #include <GLUT/glut.h>
+#else
+    #include <GL/glut.h>
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+    #include <windows.h>
+#else
+    #include <sys/time.h>
+    #include <unistd.h>
+#endif
+
+
+// ------------------------------------------------------- global variables ---
+const char * filename = "fonts/Vera.ttf";
+const int frames = 120;
+const int line_length = 48;
+wchar_t charset[1024];
+size_t charset_size = 0;
+
+
+// ------------------------------------------------------------ make_charset ---
+// Latin (basic, latin-1, extended A & B), Greek and Cyrillic
+void make_charset( void )
+{
+    wchar_t c;
+
+    for( c=0x20; c<0x250; ++c )
+    {
+        if( (c < 0x7f) || (c > 0x9f) )
+        {
+            charset[charset_size++] = c;
+        }
+    }
+    for( c=0x370; c<0x500; ++c )
+    {
+        charset[charset_size++] = c;
+    }
+    charset[charset_size] = 0;
+}
+
+
+// --------------------------------------------------------------------- now ---
+// Wall clock in milliseconds (GLUT_ELAPSED_TIME is too coarse for a frame)
+double now( void )
+{
+#if defined(_WIN32) || defined(_WIN64)
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter( &counter );
+    QueryPerformanceFrequency( &frequency );
+    return counter.QuadPart * 1000.0 / frequency.QuadPart;
+#else
+    struct timeval tv;
+    gettimeofday( &tv, NULL );
+    return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+
+// ------------------------------------------------------------ wait_vsync ---
+// Idle time between frames, during which rasterization thread may run
+void wait_vsync( void )
+{
+#if defined(_WIN32) || defined(_WIN64)
+    Sleep( 16 );
+#else
+    usleep( 16000 );
+#endif
+}
+
+
+// ------------------------------------------------------------------ layout ---
+float layout( texture_font_t * font, const wchar_t * text )
+{
+    texture_glyph_t *glyph;
+    float pen_x = 0;
+    size_t i;
+
+    for( i=0; text[i]; ++i )
+    {
+        glyph = texture_font_get_glyph( font, text[i] );
+        if( glyph )
+        {
+            if( i )
+            {
+                pen_x += texture_glyph_get_kerning( glyph, text[i-1] );
+            }
+            pen_x += glyph->advance_x;
+        }
+    }
+    return pen_x;
+}
+
+
+// ------------------------------------------------------------ count_pending ---
+size_t count_pending( texture_font_t * font )
+{
+    size_t i, pending = 0;
+
+    for( i=0; i<vector_size( font->glyphs ); ++i )
+    {
+        pending += (*(texture_glyph_t **) vector_get( font->glyphs, i ))->pending;
+    }
+    return pending;
+}
+
+
+// ------------------------------------------------------------ wait_glyphs ---
+// Commit glyphs until none is pending (or give up after a few seconds)
+void wait_glyphs( texture_font_t * font )
+{
+    int i;
+
+    for( i=0; (i<200) && count_pending( font ); ++i )
+    {
+        wait_vsync( );
+        texture_font_update_glyphs( font );
+    }
+}
+
+
+// ------------------------------------------------------------- check_full ---
+// Glyphs that do not fit in a full atlas are requested again once eviction
+// freed some space
+void check_full( void )
+{
+    texture_atlas_t *atlas;
+    texture_font_t *font;
+    texture_glyph_t *glyph;
+    wchar_t *text = L"ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    wchar_t missing = 0;
+    size_t i, placed;
+
+    atlas = texture_atlas_new( 128, 128, 1 );
+    atlas->max_width = atlas->max_height = 128;
+    font = texture_font_new( atlas, filename, 48 );
+    font->async = 1;
+    for( i=0; text[i]; ++i )
+    {
+        texture_font_get_glyph( font, text[i] );
+    }
+    wait_glyphs( font );
+    placed = vector_size( font->glyphs ) - 1;
+    for( i=0; text[i] && !missing; ++i )
+    {
+        glyph = texture_font_get_glyph( font, text[i] );
+        if( glyph && glyph->pending )
+        {
+            missing = text[i];
+        }
+    }
+    if( missing )
+    {
+        // Evict everything but the glyph just requested again
+        texture_font_remove_glyphs( font, atlas->clock );
+        wait_glyphs( font );
+        glyph = texture_font_get_glyph( font, missing );
+    }
+    printf( "Full atlas: %d of %d glyphs placed, '%lc' %s after eviction\n",
+            (int) placed, (int) wcslen( text ), missing ? missing : L'-',
+            (glyph && !glyph->pending && glyph->width) ? "resolved"
+                                                       : "NOT resolved" );
+    texture_font_delete( font );
+    texture_atlas_delete( atlas );
+}
+
+
+// --------------------------------------------------------------------- run ---
+// Each frame lays out a line of text made of recently seen characters and a
+// few that are used for the first time, as a scrolling chat or log would.
+void run( const float size, const int async )
+{
+    texture_atlas_t *atlas;
+    texture_font_t *font;
+    wchar_t text[64];
+    double start, time, total = 0, worst = 0;
+    size_t i, ready, relayouts = 0, pending = 0, first = 0;
+    int frame;
+
+    atlas = texture_atlas_new( 1024, 1024, 1 );
+    font = texture_font_new( atlas, filename, size );
+    font->async = async;
+    for( frame=0; frame<frames; ++frame )
+    {
+        start = now( );
+        if( async )
+        {
+            ready = texture_font_update_glyphs( font );
+            if( ready )
+            {
+                // Lines using glyphs that were pending would be laid out
+                // again here
+                relayouts++;
+            }
+        }
+        for( i=0; i<(size_t)line_length; ++i )
+        {
+            text[i] = charset[(first + i) % charset_size];
+        }
+        text[line_length] = 0;
+        first += 8;
+        layout( font, text );
+        time = now( ) - start;
+        total += time;
+        worst = time > worst ? time : worst;
+        wait_vsync( );
+    }
+    pending = count_pending( font );
+    printf( "%6.0fpt %-6s %10.3f %10.3f %10d %10d\n", size,
+            async ? "async" : "sync", total / frames, worst,
+            (int) relayouts, (int) pending );
+    texture_font_delete( font );
+    texture_atlas_delete( atlas );
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    float sizes[] = { 24, 48, 96 };
+    size_t i;
+
+    glutInit( &argc, argv );
+    glutInitWindowSize( 100, 100 );
+    glutInitDisplayMode( GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH );
+    glutCreateWindow( "Freetype OpenGL asynchronous glyph loading benchmark" );
+
+    GLenum err = glewInit();
+    if (GLEW_OK != err)
+    {
+        /* Problem: glewInit failed, something is seriously wrong. */
+        fprintf( stderr, "Error: %s\n", glewGetErrorString(err) );
+        exit( EXIT_FAILURE );
+    }
+    make_charset( );
+
+    printf( "%d frames of %d characters, 8 used for the first time per frame\n",
+            frames, line_length );
+    printf( "%8s %-6s %10s %10s %10s %10s\n", "size", "mode",
+            "avg (ms)", "max (ms)", "relayouts", "pending" );
+    for( i=0; i<3; ++i )
+    {
+        run( sizes[i], 0 );
+        run( sizes[i], 1 );
+    }
+    check_full( );
+    return EXIT_SUCCESS;
+}
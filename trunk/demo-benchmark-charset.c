@@ -0,0 +1,165 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <time.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+
+#if defined(__APPLE__)
+    #include <Glut/glut.h>
+#elif defined(_WIN32) || defined(_WIN64)
+    #include <GLUT/glut.h>
+#else
+    #include <GL/glut.h>
+#endif
+
+
+// ------------------------------------------------------- global variables ---
+const char * filename = "fonts/Vera.ttf";
+const size_t atlas_size = 1024;
+wchar_t charset[1024];
+
+
+// ------------------------------------------------------------ make_charset ---
+// Latin (basic, latin-1, extended A & B), Greek and Cyrillic
+void make_charset( void )
+{
+    size_t count = 0;
+    wchar_t c;
+
+    for( c=0x20; c<0x250; ++c )
+    {
+        if( (c < 0x7f) || (c > 0x9f) )
+        {
+            charset[count++] = c;
+        }
+    }
+    for( c=0x370; c<0x500; ++c )
+    {
+        charset[count++] = c;
+    }
+    charset[count] = 0;
+}
+
+
+// -------------------------------------------------------------------- load ---
+void load( const char * name, const float size, const int method )
+{
+    texture_atlas_t *atlas;
+    texture_font_t *font;
+    texture_glyph_t *glyph;
+    clock_t start;
+    double elapsed;
+    size_t i, missed = 0, top = 0;
+    ivec4 region;
+
+    atlas = texture_atlas_new( atlas_size, atlas_size, 1 );
+    atlas->max_width = atlas->max_height = atlas_size;
+    font = texture_font_new( atlas, filename, size );
+    atlas->upload_count = 0;
+
+    start = clock( );
+    if( method == 0 )
+    {
+        for( i=0; i<wcslen( charset ); ++i )
+        {
+            missed += texture_font_get_glyph( font, charset[i] ) == NULL;
+        }
+    }
+    else if( method == 1 )
+    {
+        missed = texture_font_load_glyphs( font, charset );
+    }
+    else
+    {
+        missed = texture_font_load_charset( font, charset );
+    }
+    elapsed = (clock( ) - start) / (double) CLOCKS_PER_SEC;
+
+    // Height of the atlas actually used by glyphs
+    for( i=0; i<vector_size( font->glyphs ); ++i )
+    {
+        glyph = *(texture_glyph_t **) vector_get( font->glyphs, i );
+        region = texture_font_get_glyph_region( font, glyph );
+        if( (size_t)(region.y + region.height) > top )
+        {
+            top = region.y + region.height;
+        }
+    }
+    printf( "%6.0f %14s %8d %8d %10.2f %10d %10.2f%%\n",
+            size, name, (int) vector_size( font->glyphs ), (int) missed,
+            1000.0*elapsed, (int) top,
+            100.0*atlas->used/(double)(atlas->width*top) );
+
+    texture_font_delete( font );
+    texture_atlas_delete( atlas );
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    float sizes[] = { 12, 24, 48 };
+    size_t i;
+
+    glutInit( &argc, argv );
+    glutInitWindowSize( 100, 100 );
+    glutInitDisplayMode( GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH );
+    glutCreateWindow( "Freetype OpenGL charset benchmark" );
+
+    GLenum err = glewInit();
+    if (GLEW_OK != err)
+    {
+        /* Problem: glewInit failed, something is seriously wrong. */
+        fprintf( stderr, "Error: %s\n", glewGetErrorString(err) );
+        exit( EXIT_FAILURE );
+    }
+    if( argc > 1 )
+    {
+        filename = argv[1];
+    }
+    make_charset( );
+
+    printf( "Loading %d characters (Latin, Greek, Cyrillic) from \"%s\"\n",
+            (int) wcslen( charset ), filename );
+    printf( "%6s %14s %8s %8s %10s %10s %11s\n", "size", "method", "glyphs",
+            "missed", "ms", "height", "occupancy" );
+    for( i=0; i<sizeof(sizes)/sizeof(sizes[0]); ++i )
+    {
+        load( "get_glyph", sizes[i], 0 );
+        load( "load_glyphs", sizes[i], 1 );
+        load( "load_charset", sizes[i], 2 );
+    }
+    return EXIT_SUCCESS;
+}
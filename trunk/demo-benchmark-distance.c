@@ -0,0 +1,269 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <math.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+#include "distance-field.h"
+
+#if defined(__APPLE__)
+    #include <Glut/glut.h>
+#elif defined(_WIN32) || defined(_WIN64)
+    #include <GLUT/glut.h>
+#else
+    #include <GL/glut.h>
+#endif
+
+
+// ------------------------------------------------------- global variables ---
+const char * filenames[] = { "fonts/Vera.ttf", "fonts/VeraMono.ttf",
+                             "fonts/VeraMoBd.ttf", "fonts/VeraMoIt.ttf",
+                             "fonts/VeraMoBI.ttf", "fonts/ObelixPro.ttf" };
+const wchar_t * charset = L" !\"#$%&'()*+,-./0123456789:;<=>?"
+                          L"@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_"
+                          L"`abcdefghijklmnopqrstuvwxyz{|}~";
+// Glyphs compared to the ground truth
+const char * samples = "@&%8BQSagkx";
+// Glyph size, oversampling of the ground truth and padding (pixels)
+#define SIZE       32
+#define OVERSAMPLE 8
+#define PADDING    4
+// Levels per pixel of distance
+#define SCALE      (128.0/PADDING)
+
+
+// ---------------------------------------------------------------- compare ---
+// Compare the distance fields of both engines to a brute force distance to
+// the outline, taken from a glyph rendered OVERSAMPLE times larger which
+// is also box filtered to get the anti-aliased bitmap given to the engines
+void compare( FT_Face face, char charcode, double * error, double * max_error,
+              size_t * count )
+{
+    FT_Bitmap *bitmap;
+    unsigned char *hires, *img, *out;
+    size_t w, h, W, H, x, y, X, Y, i, j, k, engine, edges;
+    float *edge_x, *edge_y;
+    double cx, cy, d, dx, dy, best, e;
+    int inside, sum;
+
+    FT_Load_Char( face, charcode, FT_LOAD_RENDER | FT_LOAD_NO_HINTING );
+    bitmap = &face->glyph->bitmap;
+    w = (bitmap->width + OVERSAMPLE-1)/OVERSAMPLE + 2*PADDING;
+    h = (bitmap->rows + OVERSAMPLE-1)/OVERSAMPLE + 2*PADDING;
+    W = w*OVERSAMPLE;
+    H = h*OVERSAMPLE;
+    hires = (unsigned char *) calloc( W*H, 1 );
+    img = (unsigned char *) malloc( w*h );
+    out = (unsigned char *) malloc( w*h );
+    edge_x = (float *) malloc( 2*W*H*sizeof(float) );
+    edge_y = (float *) malloc( 2*W*H*sizeof(float) );
+    for( Y=0; Y<(size_t)bitmap->rows; ++Y )
+    {
+        for( X=0; X<(size_t)bitmap->width; ++X )
+        {
+            hires[(Y+PADDING*OVERSAMPLE)*W + X+PADDING*OVERSAMPLE] =
+                bitmap->buffer[Y*bitmap->pitch + X] >= 128;
+        }
+    }
+
+    // Outline: middles of neighbour high resolution pixels on both sides
+    edges = 0;
+    for( Y=0; Y<H; ++Y )
+    {
+        for( X=0; X<W; ++X )
+        {
+            if( (X+1 < W) && (hires[Y*W+X] != hires[Y*W+X+1]) )
+            {
+                edge_x[edges] = X + 1.0f;
+                edge_y[edges++] = Y + 0.5f;
+            }
+            if( (Y+1 < H) && (hires[Y*W+X] != hires[(Y+1)*W+X]) )
+            {
+                edge_x[edges] = X + 0.5f;
+                edge_y[edges++] = Y + 1.0f;
+            }
+        }
+    }
+
+    // Anti-aliased bitmap
+    for( y=0; y<h; ++y )
+    {
+        for( x=0; x<w; ++x )
+        {
+            sum = 0;
+            for( j=0; j<OVERSAMPLE; ++j )
+            {
+                for( i=0; i<OVERSAMPLE; ++i )
+                {
+                    sum += hires[(y*OVERSAMPLE+j)*W + x*OVERSAMPLE+i];
+                }
+            }
+            img[y*w+x] = (unsigned char)
+                ( sum * 255 / (OVERSAMPLE*OVERSAMPLE) );
+        }
+    }
+
+    for( engine=0; engine<2; ++engine )
+    {
+        make_distance_field( img, out, w, h, SCALE, (int) engine );
+        for( k=0; k<w*h; ++k )
+        {
+            x = k % w;
+            y = k / w;
+            cx = (x + 0.5) * OVERSAMPLE;
+            cy = (y + 0.5) * OVERSAMPLE;
+            best = 1e20;
+            for( i=0; i<edges; ++i )
+            {
+                dx = edge_x[i] - cx;
+                dy = edge_y[i] - cy;
+                d = dx*dx + dy*dy;
+                best = d < best ? d : best;
+            }
+            d = sqrt( best ) / OVERSAMPLE;
+            // Only distances that are encoded without clamping
+            if( d > PADDING - 0.5 )
+            {
+                continue;
+            }
+            inside = hires[(size_t) cy * W + (size_t) cx];
+            e = fabs( (out[k] - 128) / SCALE - (inside ? d : -d) );
+            error[engine] += e;
+            max_error[engine] = e > max_error[engine] ? e : max_error[engine];
+            count[engine] += 1;
+        }
+    }
+    free( hires );
+    free( img );
+    free( out );
+    free( edge_x );
+    free( edge_y );
+}
+
+
+// ------------------------------------------------------------------- time ---
+// Milliseconds taken by an engine on an atlas of the given size filled
+// with glyphs at increasing sizes
+int time_engine( size_t size, int engine )
+{
+    texture_atlas_t *atlas = texture_atlas_new( size, size, 1 );
+    texture_font_t *font;
+    unsigned char *out = (unsigned char *) malloc( size*size );
+    float pt;
+    int start;
+
+    atlas->max_width = atlas->max_height = size;
+    for( pt=8; ; pt+=2 )
+    {
+        font = texture_font_new( atlas, filenames[0], pt );
+        if( texture_font_load_charset( font, charset ) )
+        {
+            texture_font_delete( font );
+            break;
+        }
+        texture_font_delete( font );
+    }
+    start = glutGet( GLUT_ELAPSED_TIME );
+    make_distance_field( atlas->data, out, size, size, 16, engine );
+    start = glutGet( GLUT_ELAPSED_TIME ) - start;
+    free( out );
+    texture_atlas_delete( atlas );
+    return start;
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    const char *names[] = { "edtaa3", "exact" };
+    size_t sizes[] = { 512, 1024, 2048 };
+    double error[2], max_error[2];
+    size_t count[2], i, j, engine;
+    FT_Library library;
+    FT_Face face;
+
+    glutInit( &argc, argv );
+    glutInitWindowSize( 100, 100 );
+    glutInitDisplayMode( GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH );
+    glutCreateWindow( "Freetype OpenGL distance transform engines" );
+
+    GLenum err = glewInit();
+    if (GLEW_OK != err)
+    {
+        /* Problem: glewInit failed, something is seriously wrong. */
+        fprintf( stderr, "Error: %s\n", glewGetErrorString(err) );
+        exit( EXIT_FAILURE );
+    }
+
+    FT_Init_FreeType( &library );
+    printf( "Error to the outline (pixels) of \"%s\" at %d pixels\n",
+            samples, SIZE );
+    printf( "                      edtaa3 mean/max    exact mean/max\n" );
+    for( i=0; i<sizeof(filenames)/sizeof(char *); ++i )
+    {
+        if( FT_New_Face( library, filenames[i], 0, &face ) )
+        {
+            fprintf( stderr, "Cannot load \"%s\"\n", filenames[i] );
+            continue;
+        }
+        FT_Set_Pixel_Sizes( face, 0, SIZE*OVERSAMPLE );
+        for( engine=0; engine<2; ++engine )
+        {
+            error[engine] = max_error[engine] = 0;
+            count[engine] = 0;
+        }
+        for( j=0; samples[j]; ++j )
+        {
+            compare( face, samples[j], error, max_error, count );
+        }
+        printf( "%-20s : %6.3f / %5.3f    %6.3f / %5.3f\n", filenames[i],
+                error[0]/count[0], max_error[0],
+                error[1]/count[1], max_error[1] );
+        FT_Done_Face( face );
+    }
+    FT_Done_FreeType( library );
+
+    printf( "\nTime on atlases filled with \"%s\"\n", filenames[0] );
+    for( i=0; i<sizeof(sizes)/sizeof(size_t); ++i )
+    {
+        printf( "%4dx%-4d :", (int) sizes[i], (int) sizes[i] );
+        for( engine=0; engine<2; ++engine )
+        {
+            printf( "   %s %5d ms", names[engine],
+                    time_engine( sizes[i], (int) engine ) );
+        }
+        printf( "\n" );
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,239 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <math.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+#include "edtaa3func.h"
+#include "distance-field.h"
+
+#if defined(__APPLE__)
+    #include <Glut/glut.h>
+#elif defined(_WIN32) || defined(_WIN64)
+    #include <GLUT/glut.h>
+#else
+    #include <GL/glut.h>
+#endif
+
+
+// ------------------------------------------------------- global variables ---
+const char * filename = "fonts/Vera.ttf";
+const wchar_t * charset = L" !\"#$%&'()*+,-./0123456789:;<=>?"
+                          L"@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_"
+                          L"`abcdefghijklmnopqrstuvwxyz{|}~";
+
+
+// ------------------------------------------------------------------- fill ---
+// Atlas of the given size filled with the charset at increasing sizes
+texture_atlas_t * fill( size_t size )
+{
+    texture_atlas_t *atlas = texture_atlas_new( size, size, 1 );
+    texture_font_t *font;
+    float pt;
+
+    atlas->max_width = atlas->max_height = size;
+
+    for( pt=8; ; pt+=2 )
+    {
+        font = texture_font_new( atlas, filename, pt );
+        if( texture_font_load_charset( font, charset ) )
+        {
+            texture_font_delete( font );
+            break;
+        }
+        texture_font_delete( font );
+    }
+    return atlas;
+}
+
+
+// -------------------------------------------------------------- distances ---
+// Signed distances (positive inside) in double precision, the way
+// make_distance_field used to compute them, and in single precision
+void distances( const unsigned char * img, size_t width, size_t height,
+                double * dist )
+{
+    size_t i, n = width*height;
+    double *data  = (double *) calloc( n, sizeof(double) );
+    double *gx    = (double *) calloc( n, sizeof(double) );
+    double *gy    = (double *) calloc( n, sizeof(double) );
+    double *outside = (double *) calloc( n, sizeof(double) );
+    short *xdist  = (short *) calloc( n, sizeof(short) );
+    short *ydist  = (short *) calloc( n, sizeof(short) );
+
+    for( i=0; i<n; ++i )
+    {
+        data[i] = img[i] / 255.0;
+    }
+    computegradient( data, width, height, gx, gy );
+    edtaa3( data, gx, gy, width, height, xdist, ydist, outside );
+    for( i=0; i<n; ++i )
+    {
+        data[i] = 1 - data[i];
+        gx[i] = gy[i] = 0;
+    }
+    computegradient( data, width, height, gx, gy );
+    edtaa3( data, gx, gy, width, height, xdist, ydist, dist );
+    for( i=0; i<n; ++i )
+    {
+        dist[i] = (dist[i] < 0 ? 0 : dist[i])
+                - (outside[i] < 0 ? 0 : outside[i]);
+    }
+    free( data );
+    free( gx );
+    free( gy );
+    free( outside );
+    free( xdist );
+    free( ydist );
+}
+
+void distancesf( const unsigned char * img, size_t width, size_t height,
+                 float * dist )
+{
+    size_t i, n = width*height;
+    float *data  = (float *) calloc( n, sizeof(float) );
+    float *gx    = (float *) calloc( n, sizeof(float) );
+    float *gy    = (float *) calloc( n, sizeof(float) );
+    float *outside = (float *) calloc( n, sizeof(float) );
+    short *xdist = (short *) calloc( n, sizeof(short) );
+    short *ydist = (short *) calloc( n, sizeof(short) );
+
+    for( i=0; i<n; ++i )
+    {
+        data[i] = img[i] / 255.0f;
+    }
+    computegradientf( data, width, height, gx, gy );
+    edtaa3f( data, gx, gy, width, height, xdist, ydist, outside );
+    for( i=0; i<n; ++i )
+    {
+        data[i] = 1 - data[i];
+        gx[i] = gy[i] = 0;
+    }
+    computegradientf( data, width, height, gx, gy );
+    edtaa3f( data, gx, gy, width, height, xdist, ydist, dist );
+    for( i=0; i<n; ++i )
+    {
+        dist[i] = (dist[i] < 0 ? 0 : dist[i])
+                - (outside[i] < 0 ? 0 : outside[i]);
+    }
+    free( data );
+    free( gx );
+    free( gy );
+    free( outside );
+    free( xdist );
+    free( ydist );
+}
+
+
+// ------------------------------------------------------------------ level ---
+unsigned char level( double dist, double scale )
+{
+    double v = 128 + dist*scale;
+    return v < 0 ? 0 : (v > 255 ? 255 : (unsigned char) v);
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    size_t sizes[] = { 512, 1024 };
+    double scale = 16, error, max_error;
+    size_t i, j, n;
+    int start, elapsed[3], max_level;
+    texture_atlas_t *atlas;
+    unsigned char *out;
+    double *dist;
+    float *distf;
+
+    glutInit( &argc, argv );
+    glutInitWindowSize( 100, 100 );
+    glutInitDisplayMode( GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH );
+    glutCreateWindow( "Freetype OpenGL distance transform benchmark" );
+
+    GLenum err = glewInit();
+    if (GLEW_OK != err)
+    {
+        /* Problem: glewInit failed, something is seriously wrong. */
+        fprintf( stderr, "Error: %s\n", glewGetErrorString(err) );
+        exit( EXIT_FAILURE );
+    }
+
+    printf( "Distance transform of atlases filled with \"%s\"\n", filename );
+    printf( "              double      float  threaded  "
+            "max error  max level\n" );
+    for( i=0; i<sizeof(sizes)/sizeof(size_t); ++i )
+    {
+        atlas = fill( sizes[i] );
+        n = atlas->width * atlas->height;
+        dist  = (double *) malloc( n * sizeof(double) );
+        distf = (float *) malloc( n * sizeof(float) );
+        out   = (unsigned char *) malloc( n );
+
+        start = glutGet( GLUT_ELAPSED_TIME );
+        distances( atlas->data, atlas->width, atlas->height, dist );
+        elapsed[0] = glutGet( GLUT_ELAPSED_TIME ) - start;
+        start = glutGet( GLUT_ELAPSED_TIME );
+        distancesf( atlas->data, atlas->width, atlas->height, distf );
+        elapsed[1] = glutGet( GLUT_ELAPSED_TIME ) - start;
+        start = glutGet( GLUT_ELAPSED_TIME );
+        make_distance_field( atlas->data, out,
+                             atlas->width, atlas->height, scale,
+                             DISTANCE_FIELD_EDTAA3 );
+        elapsed[2] = glutGet( GLUT_ELAPSED_TIME ) - start;
+
+        max_error = 0;
+        max_level = 0;
+        for( j=0; j<n; ++j )
+        {
+            error = fabs( distf[j] - dist[j] );
+            max_error = error > max_error ? error : max_error;
+            if( abs( out[j] - level( dist[j], scale ) ) > max_level )
+            {
+                max_level = abs( out[j] - level( dist[j], scale ) );
+            }
+        }
+        printf( "%4dx%-4d : %6d ms  %6d ms  %5d ms  %7.5f px  %9d\n",
+                (int) atlas->width, (int) atlas->height,
+                elapsed[0], elapsed[1], elapsed[2], max_error, max_level );
+
+        free( dist );
+        free( distf );
+        free( out );
+        texture_atlas_delete( atlas );
+    }
+    printf( "Memory per pixel: %d bytes in double, %d in float\n",
+            (int)( 5*sizeof(double) + 2*sizeof(short) ),
+            (int)( 5*sizeof(float) + 2*sizeof(short) ) );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <time.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+
+#if defined(__APPLE__)
+    #include <Glut/glut.h>
+#elif defined(_WIN32) || defined(_WIN64)
+    #include <GLUT/glut.h>
+#else
+    #include <GL/glut.h>
+#endif
+
+
+// ------------------------------------------------------- global variables ---
+const char * filename = "fonts/Vera.ttf";
+const float size = 12;
+const int rounds = 20;
+
+
+// ------------------------------------------------------------ reopen_face ---
+// This is what used to be done (twice) for every glyph cache miss: open the
+// library, parse the font file and set the char size.
+void reopen_face( void )
+{
+    FT_Library library;
+    FT_Face face;
+
+    FT_Init_FreeType( &library );
+    FT_New_Face( library, filename, 0, &face );
+    FT_Select_Charmap( face, FT_ENCODING_UNICODE );
+    FT_Set_Char_Size( face, (int)(size*64), 0, 72*64, 72 );
+    FT_Done_Face( face );
+    FT_Done_FreeType( library );
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    int i;
+    wchar_t charcode;
+    size_t misses = 0;
+    clock_t start;
+    double miss_time, reopen_time;
+
+    glutInit( &argc, argv );
+    glutInitWindowSize( 100, 100 );
+    glutInitDisplayMode( GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH );
+    glutCreateWindow( "Freetype OpenGL face benchmark" );
+
+    GLenum err = glewInit();
+    if (GLEW_OK != err)
+    {
+        /* Problem: glewInit failed, something is seriously wrong. */
+        fprintf( stderr, "Error: %s\n", glewGetErrorString(err) );
+        exit( EXIT_FAILURE );
+    }
+
+    printf( "Measuring glyph cache miss cost on \"%s\" (size=%.1f)...\n",
+            filename, size );
+
+    /* Cache misses with a persistent face */
+    start = clock();
+    for( i=0; i<rounds; ++i )
+    {
+        texture_atlas_t * atlas = texture_atlas_new( 512, 512, 1 );
+        texture_font_t * font = texture_font_new( atlas, filename, size );
+        for( charcode=32; charcode<127; ++charcode )
+        {
+            texture_font_get_glyph( font, charcode );
+            ++misses;
+        }
+        texture_font_delete( font );
+        texture_atlas_delete( atlas );
+    }
+    miss_time = (clock() - start) / (double) CLOCKS_PER_SEC;
+
+    /* What reopening the face twice per miss would add on top of that */
+    start = clock();
+    for( i=0; i<(int)misses; ++i )
+    {
+        reopen_face( );
+        reopen_face( );
+    }
+    reopen_time = (clock() - start) / (double) CLOCKS_PER_SEC;
+
+    printf( "Number of misses: %d\n", (int)misses );
+    printf( "Per-miss cost (persistent face)       : %8.2f us\n",
+            1e6 * miss_time / misses );
+    printf( "Per-miss cost (face reopened per call): %8.2f us\n",
+            1e6 * (miss_time + reopen_time) / misses );
+
+    return EXIT_SUCCESS;
+}
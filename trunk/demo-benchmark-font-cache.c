@@ -0,0 +1,169 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+#include "font-cache.h"
+
+
+// ------------------------------------------------------- global variables ---
+const char * filename = "fonts/Vera.ttf";
+const char * cache_filename = "/tmp/benchmark-font-cache.ftgl";
+const int rounds = 50;
+wchar_t * cache = 
+    L" !\"#$%&'()*+,-./0123456789:;<=>?"
+    L"@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_"
+    L"`abcdefghijklmnopqrstuvwxyz{|}~";
+
+
+// -------------------------------------------------------------- load_font ---
+// Font loaded with freetype, without uploading its atlas
+texture_font_t * load_font( const float size, const size_t atlas_size )
+{
+    texture_atlas_t * atlas = texture_atlas_new( atlas_size, atlas_size, 1 );
+    texture_font_t * font;
+
+    atlas->upload = 0;
+    font = texture_font_new( atlas, filename, size );
+    texture_font_load_glyphs( font, cache );
+    return font;
+}
+
+
+// ---------------------------------------------------------------- compare ---
+// Number of differences between two fonts (atlas, glyphs and kerning)
+size_t compare( texture_font_t * a, texture_font_t * b )
+{
+    texture_glyph_t *x, *y;
+    size_t i, j, n = wcslen( cache ), errors = 0;
+
+    if( (a->atlas->width != b->atlas->width) ||
+        (a->atlas->height != b->atlas->height) ||
+        memcmp( a->atlas->data, b->atlas->data,
+                a->atlas->width*a->atlas->height*a->atlas->depth ) ||
+        (a->ascender != b->ascender) || (a->height != b->height) )
+    {
+        errors++;
+    }
+    for( i=0; i<n; ++i )
+    {
+        x = texture_font_get_glyph( a, cache[i] );
+        y = texture_font_get_glyph( b, cache[i] );
+        if( !x || !y || (x->width != y->width) || (x->height != y->height) ||
+            (x->offset_x != y->offset_x) || (x->offset_y != y->offset_y) ||
+            (x->advance_x != y->advance_x) || (x->s0 != y->s0) ||
+            (x->t0 != y->t0) || (x->s1 != y->s1) || (x->t1 != y->t1) )
+        {
+            errors++;
+        }
+        for( j=0; j<n; ++j )
+        {
+            if( texture_font_get_kerning( a, cache[i], cache[j] ) !=
+                texture_font_get_kerning( b, cache[i], cache[j] ) )
+            {
+                errors++;
+            }
+        }
+    }
+    return errors;
+}
+
+
+// -------------------------------------------------------------- benchmark ---
+void benchmark( const float size, const size_t atlas_size )
+{
+    texture_font_t *font, *cached;
+    texture_atlas_t *atlas;
+    clock_t start;
+    double freetype_time, cache_time;
+    size_t errors, file_size;
+    int i;
+
+    start = clock();
+    for( i=0; i<rounds; ++i )
+    {
+        font = load_font( size, atlas_size );
+        atlas = font->atlas;
+        texture_font_delete( font );
+        texture_atlas_delete( atlas );
+    }
+    freetype_time = (clock() - start) / (double) CLOCKS_PER_SEC;
+
+    font = load_font( size, atlas_size );
+    font_cache_save( font, cache_filename );
+
+    start = clock();
+    for( i=0; i<rounds; ++i )
+    {
+        cached = font_cache_load( cache_filename );
+        atlas = cached->atlas;
+        texture_font_delete( cached );
+        texture_atlas_delete( atlas );
+    }
+    cache_time = (clock() - start) / (double) CLOCKS_PER_SEC;
+
+    cached = font_cache_load( cache_filename );
+    errors = compare( font, cached );
+    file_size = cached->atlas->mapping_size;
+    atlas = cached->atlas;
+    texture_font_delete( cached );
+    texture_atlas_delete( atlas );
+    atlas = font->atlas;
+    texture_font_delete( font );
+    texture_atlas_delete( atlas );
+
+    printf( "%6.1f %6d %10d %12.3f %12.3f %8.1f %8d\n", size,
+            (int) atlas_size, (int) file_size,
+            1e3 * freetype_time / rounds, 1e3 * cache_time / rounds,
+            freetype_time / cache_time, (int) errors );
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    // Neither path uploads the atlas: no OpenGL context is needed
+    printf( "Font loading with freetype versus font cache on \"%s\" "
+            "(%d glyphs, %d rounds)\n", filename, (int) wcslen(cache), rounds );
+    printf( "%6s %6s %10s %12s %12s %8s %8s\n", "size", "atlas", "bytes",
+            "freetype ms", "cache ms", "speedup", "errors" );
+    benchmark( 16, 256 );
+    benchmark( 32, 512 );
+    benchmark( 64, 1024 );
+    remove( cache_filename );
+
+    return EXIT_SUCCESS;
+}
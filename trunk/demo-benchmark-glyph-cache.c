@@ -0,0 +1,122 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <time.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+
+
+// ------------------------------------------------------- global variables ---
+const size_t counts[] = { 100, 500, 1000, 2000, 5000, 10000, 20000 };
+const size_t lookups = 200000;
+
+
+// ------------------------------------------------------------ linear_find ---
+// This is how texture_font_get_glyph used to look for an already loaded glyph
+texture_glyph_t *
+linear_find( texture_font_t * font, wchar_t charcode )
+{
+    size_t i;
+    for( i=0; i<font->glyphs->size; ++i )
+    {
+        texture_glyph_t *glyph = *(texture_glyph_t **) vector_get( font->glyphs, i );
+        if( (glyph->charcode == charcode) &&
+            (glyph->outline_type == font->outline_type) &&
+            (glyph->outline_thickness == font->outline_thickness) )
+        {
+            return glyph;
+        }
+    }
+    return NULL;
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    size_t i, j, n;
+    clock_t start;
+    double hash_time, linear_time;
+    size_t found = 0;
+
+    printf( "Glyph cache lookup time (CJK charcodes, %d lookups)\n",
+            (int) lookups );
+    printf( "%8s %16s %16s\n", "glyphs", "hash (ns)", "linear (ns)" );
+
+    for( i=0; i<sizeof(counts)/sizeof(counts[0]); ++i )
+    {
+        texture_atlas_t * atlas = texture_atlas_new( 512, 512, 1 );
+        texture_font_t * font = texture_font_new( atlas, "fonts/Vera.ttf", 12 );
+
+        // Glyphs are only needed for lookup, no need to rasterize them
+        n = counts[i];
+        for( j=0; j<n; ++j )
+        {
+            texture_glyph_t * glyph = texture_glyph_new( );
+            glyph->charcode = 0x4E00 + j;
+            vector_push_back( font->glyphs, &glyph );
+        }
+        // First lookup indexes the new glyphs
+        texture_font_get_glyph( font, 0x4E00 );
+
+        srand( 1 );
+        start = clock();
+        for( j=0; j<lookups; ++j )
+        {
+            found += texture_font_get_glyph( font, 0x4E00 + rand()%n ) != NULL;
+        }
+        hash_time = (clock() - start) / (double) CLOCKS_PER_SEC;
+
+        srand( 1 );
+        start = clock();
+        for( j=0; j<lookups; ++j )
+        {
+            found += linear_find( font, 0x4E00 + rand()%n ) != NULL;
+        }
+        linear_time = (clock() - start) / (double) CLOCKS_PER_SEC;
+
+        printf( "%8d %16.1f %16.1f\n", (int) n,
+                1e9 * hash_time / lookups, 1e9 * linear_time / lookups );
+
+        texture_font_delete( font );
+        texture_atlas_delete( atlas );
+    }
+    if( found != 2*lookups*(sizeof(counts)/sizeof(counts[0])) )
+    {
+        fprintf( stderr, "Some glyphs have not been found\n" );
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <time.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+
+#if defined(__APPLE__)
+    #include <Glut/glut.h>
+#elif defined(_WIN32) || defined(_WIN64)
+    #include <GLUT/glut.h>
+#else
+    #include <GL/glut.h>
+#endif
+
+
+// ------------------------------------------------------- global variables ---
+const char * filename = "fonts/Vera.ttf";
+const int rounds = 20;
+wchar_t * cache = 
+    L" !\"#$%&'()*+,-./0123456789:;<=>?"
+    L"@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_"
+    L"`abcdefghijklmnopqrstuvwxyz{|}~";
+
+
+// ------------------------------------------------------------- load_glyphs ---
+void load_glyphs( const float size, const int outline_type )
+{
+    int i;
+    size_t j, glyphs = 0, renders = 0;
+    clock_t start;
+    double load_time, extra_time;
+
+    start = clock();
+    for( i=0; i<rounds; ++i )
+    {
+        texture_atlas_t * atlas = texture_atlas_new( 512, 512, 1 );
+        texture_font_t * font = texture_font_new( atlas, filename, size );
+        font->outline_type = outline_type;
+        font->outline_thickness = 1;
+        texture_font_load_glyphs( font, cache );
+        glyphs += vector_size( font->glyphs ) - 1;
+        renders += font->render_count;
+        texture_font_delete( font );
+        texture_atlas_delete( atlas );
+    }
+    load_time = (clock() - start) / (double) CLOCKS_PER_SEC;
+
+    // Second (unhinted) rendering that used to be done for each glyph to
+    // get its advance
+    {
+        texture_atlas_t * atlas = texture_atlas_new( 512, 512, 1 );
+        texture_font_t * font = texture_font_new( atlas, filename, size );
+        start = clock();
+        for( i=0; i<rounds; ++i )
+        {
+            for( j=0; j<wcslen(cache); ++j )
+            {
+                FT_Load_Glyph( font->face,
+                               FT_Get_Char_Index( font->face, cache[j] ),
+                               FT_LOAD_RENDER | FT_LOAD_NO_HINTING );
+            }
+        }
+        extra_time = (clock() - start) / (double) CLOCKS_PER_SEC;
+        texture_font_delete( font );
+        texture_atlas_delete( atlas );
+    }
+
+    printf( "%6.1f %8d %10.2f %12.2f %14.2f\n", size, outline_type,
+            renders / (float) glyphs,
+            1e6 * load_time / glyphs,
+            1e6 * (load_time + extra_time) / glyphs );
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    glutInit( &argc, argv );
+    glutInitWindowSize( 100, 100 );
+    glutInitDisplayMode( GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH );
+    glutCreateWindow( "Freetype OpenGL glyph load benchmark" );
+
+    GLenum err = glewInit();
+    if (GLEW_OK != err)
+    {
+        /* Problem: glewInit failed, something is seriously wrong. */
+        fprintf( stderr, "Error: %s\n", glewGetErrorString(err) );
+        exit( EXIT_FAILURE );
+    }
+
+    printf( "Glyph loading cost on \"%s\" (%d glyphs, %d rounds)\n",
+            filename, (int) wcslen(cache), rounds );
+    printf( "%6s %8s %10s %12s %14s\n",
+            "size", "outline", "renders", "us/glyph", "us/glyph (2x)" );
+    load_glyphs( 12, 0 );
+    load_glyphs( 24, 0 );
+    load_glyphs( 48, 0 );
+    load_glyphs( 24, 1 );
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,155 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <math.h>
+#include <time.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+
+
+// ------------------------------------------------------- global variables ---
+const size_t lookups = 2000000;
+
+
+// ------------------------------------------------------------ check_large ---
+// Kerning values out of the 16 bits range (about 128 pixels) are kept exact,
+// whether set once or growing from a small value, among many small ones
+void check_large( void )
+{
+    kerning_table_t *table = kerning_table_new( 16 );
+    wchar_t left, right;
+    size_t errors = 0;
+
+    for( left=L'A'; left<=L'Z'; ++left )
+    {
+        for( right=L'a'; right<=L'z'; ++right )
+        {
+            kerning_table_set( table, left, right, -1.5f );
+        }
+    }
+    kerning_table_set( table, L'A', L'V', -300.25f );
+    kerning_table_set( table, L'T', L'o', 1000.0f );
+    kerning_table_set( table, L'T', L'o', -200.0f );
+    kerning_table_set( table, L'L', L'y', 64.0f );
+    kerning_table_set( table, L'L', L'y', -129.0f );
+    kerning_table_set( table, 0x1D400, L'a', 150.5f );
+
+    errors += kerning_table_get( table, L'A', L'V' ) != -300.25f;
+    errors += kerning_table_get( table, L'T', L'o' ) != -200.0f;
+    errors += kerning_table_get( table, L'L', L'y' ) != -129.0f;
+    errors += kerning_table_get( table, 0x1D400, L'a' ) != 150.5f;
+    errors += kerning_table_get( table, L'V', L'A' ) != 0.0f;
+    for( left=L'A'; left<=L'Z'; ++left )
+    {
+        for( right=L'a'; right<=L'z'; ++right )
+        {
+            if( ((left == L'T') && (right == L'o')) ||
+                ((left == L'L') && (right == L'y')) )
+            {
+                continue;
+            }
+            errors += fabsf( kerning_table_get( table, left, right ) + 1.5f )
+                      > 0.5f / KERNING_SCALE;
+        }
+    }
+    printf( "Large kerning values  : %d pairs, %d errors\n",
+            (int) table->count, (int) errors );
+    kerning_table_delete( table );
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    size_t i, n;
+    wchar_t charcode;
+    wchar_t *charcodes;
+    texture_glyph_t **glyphs;
+    clock_t start;
+    double time;
+    float total = 0;
+    kerning_stats_t stats;
+
+    texture_atlas_t * atlas = texture_atlas_new( 1024, 1024, 1 );
+    texture_font_t * font = texture_font_new( atlas, "fonts/Vera.ttf", 12 );
+
+    // Latin-1 and Latin Extended-A
+    n = 0;
+    charcodes = (wchar_t *) malloc( (0x180 - 32 + 1) * sizeof(wchar_t) );
+    for( charcode=32; charcode<0x180; ++charcode )
+    {
+        if( (charcode < 127) || (charcode >= 160) )
+        {
+            charcodes[n++] = charcode;
+        }
+    }
+    charcodes[n] = 0;
+    texture_font_load_glyphs( font, charcodes );
+
+    glyphs = (texture_glyph_t **) malloc( n * sizeof(texture_glyph_t *) );
+    for( i=0; i<n; ++i )
+    {
+        glyphs[i] = texture_font_get_glyph( font, charcodes[i] );
+    }
+
+    srand( 1 );
+    start = clock();
+    for( i=0; i<lookups; ++i )
+    {
+        total += texture_glyph_get_kerning( glyphs[rand()%n],
+                                            charcodes[rand()%n] );
+    }
+    time = (clock() - start) / (double) CLOCKS_PER_SEC;
+
+    texture_font_get_kerning_stats( font, &stats );
+    printf( "Font                  : fonts/Vera.ttf (%d glyphs)\n", (int) n );
+    printf( "Kerning pairs         : %d\n", (int) stats.pairs );
+    printf( "Kerning table memory  : %d bytes\n", (int) stats.memory );
+    printf( "Per-glyph vectors     : %d bytes in %d blocks (+ allocator overhead)\n",
+            (int) stats.vectors_memory, 2*(int) vector_size( font->glyphs ) );
+    printf( "Lookups               : %d (%.2f probes per lookup)\n",
+            (int) stats.lookups, stats.probes );
+    printf( "Filtered lookups      : %.1f%%\n", 100.0f * stats.filtered );
+    printf( "Lookup throughput     : %.1f Mlookups/second (incl. rand())\n",
+            lookups / time / 1e6 );
+    printf( "(sum of kernings: %f)\n", total );
+
+    free( glyphs );
+    free( charcodes );
+    texture_font_delete( font );
+    texture_atlas_delete( atlas );
+
+    check_large( );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <math.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+#include "font-metrics.h"
+#include "platform.h"
+
+
+// ------------------------------------------------------- global variables ---
+const char * filename = "fonts/Vera.ttf";
+const int rounds = 20;
+wchar_t * cache = 
+    L" !\"#$%&'()*+,-./0123456789:;<=>?"
+    L"@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_"
+    L"`abcdefghijklmnopqrstuvwxyz{|}~";
+wchar_t * text = L"The quick brown fox jumps over the lazy dog. "
+                 L"AVATAR Wolf To Ty, \"LT\" & {jyg}";
+
+
+// ----------------------------------------------------------------- compare ---
+// Number of glyphs and kerning pairs whose metrics differ from the ones of
+// the texture font
+size_t compare( texture_font_t * font, font_metrics_t * metrics )
+{
+    const glyph_metrics_t *m;
+    texture_glyph_t *glyph;
+    size_t i, j, n = wcslen( cache ), errors = 0;
+    int padding = (font->render_mode == TEXTURE_FONT_BITMAP)
+                ? 0 : font->padding;
+
+    for( i=0; i<n; ++i )
+    {
+        glyph = texture_font_get_glyph( font, cache[i] );
+        m = font_metrics_get_glyph( metrics, cache[i] );
+        if( !glyph || !m ||
+            (fabs( glyph->advance_x - m->advance_x ) > 1e-4) ||
+            (m->width && ((glyph->offset_x + padding != m->offset_x) ||
+                          (glyph->offset_y - padding != m->offset_y) ||
+                          (glyph->width - 2*padding != m->width) ||
+                          (glyph->height - 2*padding != m->height))) )
+        {
+            errors++;
+        }
+    }
+    // Kerning table values are quantized to 1/KERNING_SCALE pixel
+    for( i=0; i<n; ++i )
+    {
+        for( j=0; j<n; ++j )
+        {
+            if( fabs( texture_font_get_kerning( font, cache[i], cache[j] ) -
+                      font_metrics_get_kerning( metrics, cache[i], cache[j] ) )
+                > 0.5f / KERNING_SCALE + 1e-4 )
+            {
+                errors++;
+            }
+        }
+    }
+    return errors;
+}
+
+
+// ------------------------------------------------------------------ measure ---
+void measure( const float size )
+{
+    int i;
+    size_t j, n = wcslen( cache ), errors;
+    double start;
+    double font_time, metrics_time, measure_time;
+    float advance = 0;
+    vec4 bbox;
+
+    start = platform_time();
+    for( i=0; i<rounds; ++i )
+    {
+        texture_atlas_t * atlas = texture_atlas_new( 512, 512, 1 );
+        texture_font_t * font = texture_font_new( atlas, filename, size );
+        texture_font_load_glyphs( font, cache );
+        texture_font_delete( font );
+        texture_atlas_delete( atlas );
+    }
+    font_time = platform_time() - start;
+
+    start = platform_time();
+    for( i=0; i<rounds; ++i )
+    {
+        font_metrics_t * metrics = font_metrics_new( filename, size );
+        for( j=0; j<n; ++j )
+        {
+            font_metrics_get_glyph( metrics, cache[j] );
+        }
+        font_metrics_delete( metrics );
+    }
+    metrics_time = platform_time() - start;
+
+    {
+        texture_atlas_t * atlas = texture_atlas_new( 512, 512, 1 );
+        texture_font_t * font = texture_font_new( atlas, filename, size );
+        font_metrics_t * metrics = font_metrics_new( filename, size );
+        texture_font_load_glyphs( font, cache );
+        errors = compare( font, metrics );
+
+        start = platform_time();
+        for( i=0; i<1000*rounds; ++i )
+        {
+            bbox = font_metrics_measure( metrics, text, &advance );
+        }
+        measure_time = platform_time() - start;
+
+        font_metrics_delete( metrics );
+        texture_font_delete( font );
+        texture_atlas_delete( atlas );
+    }
+
+    printf( "%6.1f %14.2f %14.2f %12.2f %8.1f %9.1f %8d\n", size,
+            1e6 * font_time / (rounds * n),
+            1e6 * metrics_time / (rounds * n),
+            1e6 * measure_time / (1000 * rounds),
+            advance, bbox.height, (int) errors );
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    // No OpenGL context: metrics fonts never touch GL, and texture fonts
+    // only need one to upload their atlas
+    printf( "Texture font versus metrics only font on \"%s\" "
+            "(%d glyphs, %d rounds)\n", filename, (int) wcslen(cache), rounds );
+    printf( "%6s %14s %14s %12s %8s %9s %8s\n", "size", "font us/glyph",
+            "metrics us/gl", "us/measure", "advance", "height", "errors" );
+    measure( 12 );
+    measure( 24 );
+    measure( 48 );
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,182 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <time.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+#include FT_STROKER_H
+
+#if defined(__APPLE__)
+    #include <Glut/glut.h>
+#elif defined(_WIN32) || defined(_WIN64)
+    #include <GLUT/glut.h>
+#else
+    #include <GL/glut.h>
+#endif
+
+
+// ------------------------------------------------------- global variables ---
+const char * filename = "fonts/Vera.ttf";
+const float size = 32;
+const int rounds = 10;
+wchar_t charset[256];
+
+
+// ------------------------------------------------------------------ stroke ---
+// Stroke every glyph of the charset, with a new stroker per glyph (as
+// texture_font_render_glyph used to) or a single one
+double stroke( FT_Library library, FT_Face face, const int outline_type,
+               const float thickness, const int reuse )
+{
+    clock_t start = clock();
+    FT_Stroker stroker = NULL;
+    FT_Glyph glyph;
+    size_t i;
+    int j;
+
+    for( j=0; j<rounds; ++j )
+    {
+        for( i=0; charset[i]; ++i )
+        {
+            FT_Load_Char( face, charset[i], FT_LOAD_NO_BITMAP );
+            if( !stroker )
+            {
+                FT_Stroker_New( library, &stroker );
+            }
+            FT_Stroker_Set( stroker, (int)(thickness*64),
+                            FT_STROKER_LINECAP_ROUND,
+                            FT_STROKER_LINEJOIN_ROUND, 0 );
+            FT_Get_Glyph( face->glyph, &glyph );
+            if( outline_type == 1 )
+            {
+                FT_Glyph_Stroke( &glyph, stroker, 1 );
+            }
+            else
+            {
+                FT_Glyph_StrokeBorder( &glyph, stroker, outline_type == 2, 1 );
+            }
+            FT_Done_Glyph( glyph );
+            if( !reuse )
+            {
+                FT_Stroker_Done( stroker );
+                stroker = NULL;
+            }
+        }
+    }
+    if( stroker )
+    {
+        FT_Stroker_Done( stroker );
+    }
+    return (clock() - start) * 1000.0 / CLOCKS_PER_SEC / rounds;
+}
+
+
+// ------------------------------------------------------------------ preload ---
+// Preload of the charset in several outline fonts, as demo-cartoon does
+double preload( const int outline_type, const float thickness )
+{
+    clock_t start = clock();
+    texture_atlas_t *atlas;
+    texture_font_t *font;
+    int j;
+
+    for( j=0; j<rounds; ++j )
+    {
+        atlas = texture_atlas_new( 1024, 1024, 1 );
+        font = texture_font_new( atlas, filename, size );
+        font->outline_type = outline_type;
+        font->outline_thickness = thickness;
+        texture_font_load_charset( font, charset );
+        texture_font_delete( font );
+        texture_atlas_delete( atlas );
+    }
+    return (clock() - start) * 1000.0 / CLOCKS_PER_SEC / rounds;
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    float thicknesses[] = { 1, 2, 4 };
+    FT_Library library;
+    FT_Face face;
+    double fresh, reused;
+    int type, i;
+    wchar_t c;
+
+    glutInit( &argc, argv );
+    glutInitWindowSize( 100, 100 );
+    glutInitDisplayMode( GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH );
+    glutCreateWindow( "Freetype OpenGL outline benchmark" );
+
+    GLenum err = glewInit();
+    if (GLEW_OK != err)
+    {
+        /* Problem: glewInit failed, something is seriously wrong. */
+        fprintf( stderr, "Error: %s\n", glewGetErrorString(err) );
+        exit( EXIT_FAILURE );
+    }
+    for( c=32, i=0; c<256; ++c )
+    {
+        if( (c < 0x7f) || (c > 0x9f) )
+        {
+            charset[i++] = c;
+        }
+    }
+    charset[i] = 0;
+
+    FT_Init_FreeType( &library );
+    FT_New_Face( library, filename, 0, &face );
+    FT_Set_Char_Size( face, (int)(size*64), 0, 72, 72 );
+
+    printf( "Stroking %d glyphs of \"%s\" (size=%.0f), ms\n",
+            (int) wcslen( charset ), filename, size );
+    printf( "%-12s %9s %12s %12s %12s\n", "outline", "thickness",
+            "new stroker", "reused", "preload" );
+    for( type=1; type<=3; ++type )
+    {
+        for( i=0; i<3; ++i )
+        {
+            fresh = stroke( library, face, type, thicknesses[i], 0 );
+            reused = stroke( library, face, type, thicknesses[i], 1 );
+            printf( "%-12s %9.0f %12.3f %12.3f %12.3f\n",
+                    type == 1 ? "line" : (type == 2 ? "inner" : "outer"),
+                    thicknesses[i], fresh, reused,
+                    preload( type, thicknesses[i] ) );
+        }
+    }
+    FT_Done_Face( face );
+    FT_Done_FreeType( library );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,176 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include "texture-atlas.h"
+
+
+// ------------------------------------------------------- global variables ---
+const char * text_fonts[] = { "fonts/Vera.ttf", "fonts/VeraMono.ttf",
+                              "fonts/VeraMoBd.ttf", "fonts/VeraMoIt.ttf",
+                              "fonts/VeraMoBI.ttf", "fonts/ObelixPro.ttf",
+                              NULL };
+const float text_sizes[] = { 12, 16, 24, 32, 48, 72, 0 };
+const char * console_fonts[] = { "fonts/VeraMono.ttf", "fonts/VeraMoBd.ttf",
+                                 "fonts/VeraMoIt.ttf", "fonts/VeraMoBI.ttf",
+                                 NULL };
+const float console_sizes[] = { 16, 0 };
+const char * packer_names[] = { "skyline", "maxrects", "guillotine", "shelf" };
+const int rounds = 10;
+
+
+// ------------------------------------------------------------ glyph_sizes ---
+// Size of the regions texture_font_load_glyphs would ask for (one pixel of
+// separation) for printable ASCII and latin-1 characters.
+void
+glyph_sizes( FT_Library library, const char ** fonts, const float * sizes,
+             vector_t * result )
+{
+    FT_Face face;
+    size_t i, j;
+    unsigned long c;
+
+    for( i=0; fonts[i]; ++i )
+    {
+        if( FT_New_Face( library, fonts[i], 0, &face ) )
+        {
+            fprintf( stderr, "Cannot load %s\n", fonts[i] );
+            continue;
+        }
+        for( j=0; sizes[j] > 0; ++j )
+        {
+            FT_Set_Char_Size( face, (int)(sizes[j]*64), 0, 72, 72 );
+            for( c=32; c<256; ++c )
+            {
+                ivec2 size;
+                if( ((c >= 127) && (c < 161)) ||
+                    !FT_Get_Char_Index( face, c ) ||
+                    FT_Load_Char( face, c, FT_LOAD_RENDER ) )
+                {
+                    continue;
+                }
+                size.x = face->glyph->bitmap.width + 1;
+                size.y = face->glyph->bitmap.rows + 1;
+                vector_push_back( result, &size );
+            }
+        }
+        FT_Done_Face( face );
+    }
+}
+
+
+// ---------------------------------------------------------------- run ---
+void
+run( const char * name, vector_t * sizes, size_t atlas_size )
+{
+    int packer, round;
+    size_t i, failures, first_failure;
+    clock_t start;
+    double elapsed;
+    texture_atlas_t *atlas;
+
+    printf( "%s: %d glyphs in a %dx%d atlas\n", name,
+            (int) vector_size( sizes ), (int) atlas_size, (int) atlas_size );
+    printf( "%12s %10s %10s %14s %12s\n",
+            "packer", "failures", "occupancy", "first failure", "us/glyph" );
+    for( packer=TEXTURE_ATLAS_SKYLINE; packer<=TEXTURE_ATLAS_SHELF; ++packer )
+    {
+        elapsed = 0;
+        for( round=0; round<rounds; ++round )
+        {
+            atlas = texture_atlas_new_with_packer( atlas_size, atlas_size, 1,
+                                                   packer );
+            atlas->max_width = atlas->max_height = atlas_size;
+            failures = 0;
+            first_failure = 0;
+            start = clock( );
+            for( i=0; i<vector_size( sizes ); ++i )
+            {
+                ivec2 *size = (ivec2 *) vector_get( sizes, i );
+                if( texture_atlas_get_region( atlas, size->x, size->y ).x < 0 )
+                {
+                    if( !failures++ )
+                    {
+                        first_failure = atlas->used;
+                    }
+                }
+            }
+            elapsed += (clock( ) - start) / (double) CLOCKS_PER_SEC;
+            if( round+1 < rounds )
+            {
+                texture_atlas_delete( atlas );
+            }
+        }
+        if( !failures )
+        {
+            first_failure = atlas->used;
+        }
+        printf( "%12s %10d %9.2f%% %13.2f%% %12.3f\n",
+                packer_names[packer], (int) failures,
+                100.0*atlas->used/(atlas_size*atlas_size),
+                100.0*first_failure/(atlas_size*atlas_size),
+                1e6*elapsed/(rounds*vector_size( sizes )) );
+        texture_atlas_delete( atlas );
+    }
+    printf( "\n" );
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    FT_Library library;
+    vector_t *text = vector_new( sizeof(ivec2) );
+    vector_t *console = vector_new( sizeof(ivec2) );
+
+    if( FT_Init_FreeType( &library ) )
+    {
+        fprintf( stderr, "Unable to initialize freetype library\n" );
+        return EXIT_FAILURE;
+    }
+    glyph_sizes( library, text_fonts, text_sizes, text );
+    glyph_sizes( library, console_fonts, console_sizes, console );
+    FT_Done_FreeType( library );
+
+    // Atlas sizes are chosen such that not every glyph fits
+    run( "Text (all fonts, 12 to 72 points)", text, 1024 );
+    run( "Console (monospace fonts, 16 points)", console, 128 );
+
+    vector_delete( text );
+    vector_delete( console );
+    return EXIT_SUCCESS;
+}
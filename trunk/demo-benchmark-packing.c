@@ -0,0 +1,211 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
+#include "texture-atlas.h"
+
+
+// ------------------------------------------------------- global variables ---
+#define ATLAS_SIZE 4096
+#define RECT_COUNT 50000
+
+
+// ----------------------------------------------------- reference packer ---
+// Skyline packer as it was before pruning: every node is tried, each try
+// walks all the nodes covered by the rectangle and the whole skyline is
+// merged after each insertion.
+int
+reference_fit( vector_t * nodes, size_t index, int width, int height )
+{
+    ivec3 *node = (ivec3 *) vector_get( nodes, index );
+    int x = node->x, y = node->y, width_left = width;
+    size_t i = index;
+
+    if( (x + width) > (ATLAS_SIZE-1) )
+    {
+        return -1;
+    }
+    while( width_left > 0 )
+    {
+        node = (ivec3 *) vector_get( nodes, i );
+        if( node->y > y )
+        {
+            y = node->y;
+        }
+        if( (y + height) > (ATLAS_SIZE-1) )
+        {
+            return -1;
+        }
+        width_left -= node->z;
+        ++i;
+    }
+    return y;
+}
+
+ivec4
+reference_get_region( vector_t * nodes, int width, int height )
+{
+    int y, best_height = INT_MAX, best_width = INT_MAX, best_index = -1;
+    ivec4 region = {{-1,-1,width,height}};
+    ivec3 *node, *prev, new_node;
+    size_t i;
+
+    for( i=0; i<vector_size( nodes ); ++i )
+    {
+        y = reference_fit( nodes, i, width, height );
+        node = (ivec3 *) vector_get( nodes, i );
+        if( (y >= 0) &&
+            (( (y + height) < best_height ) ||
+             ( ((y + height) == best_height) && (node->z < best_width)) ) )
+        {
+            best_height = y + height;
+            best_index = i;
+            best_width = node->z;
+            region.x = node->x;
+            region.y = y;
+        }
+    }
+    if( best_index == -1 )
+    {
+        return region;
+    }
+    new_node.x = region.x;
+    new_node.y = region.y + height;
+    new_node.z = width;
+    vector_insert( nodes, best_index, &new_node );
+    for( i=best_index+1; i<vector_size( nodes ); ++i )
+    {
+        node = (ivec3 *) vector_get( nodes, i );
+        prev = (ivec3 *) vector_get( nodes, i-1 );
+        if( node->x >= (prev->x + prev->z) )
+        {
+            break;
+        }
+        node->z -= prev->x + prev->z - node->x;
+        node->x = prev->x + prev->z;
+        if( node->z > 0 )
+        {
+            break;
+        }
+        vector_erase( nodes, i );
+        --i;
+    }
+    for( i=0; i+1<vector_size( nodes ); ++i )
+    {
+        node = (ivec3 *) vector_get( nodes, i );
+        prev = (ivec3 *) vector_get( nodes, i+1 );
+        if( node->y == prev->y )
+        {
+            node->z += prev->z;
+            vector_erase( nodes, i+1 );
+            --i;
+        }
+    }
+    return region;
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    ivec2 *sizes = (ivec2 *) malloc( RECT_COUNT*sizeof(ivec2) );
+    ivec4 *regions = (ivec4 *) malloc( RECT_COUNT*sizeof(ivec4) );
+    int max_size = 24;
+    size_t i, packed, area, mismatches;
+    clock_t start;
+    double reference_time, atlas_time;
+
+    if( argc > 1 )
+    {
+        max_size = atoi( argv[1] );
+    }
+    srand( 12345 );
+    for( i=0; i<RECT_COUNT; ++i )
+    {
+        sizes[i].x = 4 + rand() % (max_size-3);
+        sizes[i].y = 4 + rand() % (max_size-3);
+    }
+
+    {
+        vector_t *nodes = vector_new( sizeof(ivec3) );
+        ivec3 node = {{1,1,ATLAS_SIZE-2}};
+        vector_push_back( nodes, &node );
+        start = clock( );
+        for( i=0; i<RECT_COUNT; ++i )
+        {
+            regions[i] = reference_get_region( nodes, sizes[i].x, sizes[i].y );
+        }
+        reference_time = (clock( ) - start) / (double) CLOCKS_PER_SEC;
+        vector_delete( nodes );
+    }
+
+    {
+        texture_atlas_t *atlas = texture_atlas_new( ATLAS_SIZE, ATLAS_SIZE, 1 );
+        atlas->max_width = atlas->max_height = ATLAS_SIZE;
+        packed = area = mismatches = 0;
+        start = clock( );
+        for( i=0; i<RECT_COUNT; ++i )
+        {
+            ivec4 region = texture_atlas_get_region( atlas, sizes[i].x, sizes[i].y );
+            if( region.x >= 0 )
+            {
+                packed++;
+                area += sizes[i].x * sizes[i].y;
+            }
+            if( (region.x != regions[i].x) || (region.y != regions[i].y) )
+            {
+                mismatches++;
+            }
+        }
+        atlas_time = (clock( ) - start) / (double) CLOCKS_PER_SEC;
+        texture_atlas_delete( atlas );
+    }
+
+    printf( "%d random rectangles (4 to %d pixels) in a %dx%d atlas\n",
+            RECT_COUNT, max_size, ATLAS_SIZE, ATLAS_SIZE );
+    printf( "Packed rectangles      : %d\n", (int) packed );
+    printf( "Occupancy              : %.2f%%\n",
+            100.0*area/(double)(ATLAS_SIZE*ATLAS_SIZE) );
+    printf( "Placement differences  : %d\n", (int) mismatches );
+    printf( "Previous skyline search: %8.3f s (%6.2f us/rect)\n",
+            reference_time, 1e6*reference_time/RECT_COUNT );
+    printf( "Pruned skyline search  : %8.3f s (%6.2f us/rect)\n",
+            atlas_time, 1e6*atlas_time/RECT_COUNT );
+
+    free( sizes );
+    free( regions );
+    return mismatches ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,169 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <time.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+
+#if defined(__APPLE__)
+    #include <Glut/glut.h>
+#elif defined(_WIN32) || defined(_WIN64)
+    #include <GLUT/glut.h>
+#else
+    #include <GL/glut.h>
+#endif
+
+
+// ------------------------------------------------------- global variables ---
+const char * filenames[] = { "fonts/Vera.ttf", "fonts/VeraMono.ttf" };
+const int sizes = 20;
+const int rounds = 20;
+
+
+// ------------------------------------------------------------- open_faces ---
+// What every font used to do: parse the font file from disk
+double open_faces( FT_Library library, FT_Face * faces )
+{
+    clock_t start = clock();
+    int i, j;
+
+    for( i=0; i<rounds; ++i )
+    {
+        for( j=0; j<sizes; ++j )
+        {
+            FT_New_Face( library, filenames[j%2], 0, &faces[j] );
+            FT_Set_Char_Size( faces[j], (int)((8+2*j)*64), 0, 72*64, 72 );
+        }
+        for( j=0; j<sizes; ++j )
+        {
+            FT_Done_Face( faces[j] );
+        }
+    }
+    return (clock() - start) * 1000.0 / CLOCKS_PER_SEC / rounds;
+}
+
+
+// ---------------------------------------------------- open_registry_faces ---
+// Faces created from font files mapped once by the registry
+double open_registry_faces( FT_Library library, FT_Face * faces )
+{
+    clock_t start = clock();
+    font_file_t *file;
+    int i, j;
+
+    for( i=0; i<rounds; ++i )
+    {
+        for( j=0; j<sizes; ++j )
+        {
+            file = font_registry_open( filenames[j%2] );
+            FT_New_Memory_Face( library, file->data, file->size, 0, &faces[j] );
+            FT_Set_Char_Size( faces[j], (int)((8+2*j)*64), 0, 72*64, 72 );
+        }
+        for( j=0; j<sizes; ++j )
+        {
+            FT_Done_Face( faces[j] );
+            font_registry_close( font_registry_get( j%2 ) );
+        }
+    }
+    return (clock() - start) * 1000.0 / CLOCKS_PER_SEC / rounds;
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    FT_Library library;
+    FT_Face faces[20];
+    texture_atlas_t *atlas;
+    texture_font_t *fonts[20];
+    font_file_t *file;
+    clock_t start;
+    double time;
+    size_t i, total = 0;
+
+    glutInit( &argc, argv );
+    glutInitWindowSize( 100, 100 );
+    glutInitDisplayMode( GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH );
+    glutCreateWindow( "Freetype OpenGL font registry benchmark" );
+
+    GLenum err = glewInit();
+    if (GLEW_OK != err)
+    {
+        /* Problem: glewInit failed, something is seriously wrong. */
+        fprintf( stderr, "Error: %s\n", glewGetErrorString(err) );
+        exit( EXIT_FAILURE );
+    }
+
+    printf( "%d faces (%d sizes of 2 files)\n", sizes, sizes/2 );
+    FT_Init_FreeType( &library );
+    printf( "FT_New_Face from disk         : %8.3f ms\n",
+            open_faces( library, faces ) );
+    // Keep files in the registry, as fonts in use would
+    font_registry_open( filenames[0] );
+    font_registry_open( filenames[1] );
+    printf( "FT_New_Memory_Face (registry) : %8.3f ms\n",
+            open_registry_faces( library, faces ) );
+    font_registry_close( font_registry_get( 1 ) );
+    font_registry_close( font_registry_get( 0 ) );
+    FT_Done_FreeType( library );
+
+    // Typical use: many sizes of a family, as in demo-atb-agg
+    atlas = texture_atlas_new( 512, 512, 1 );
+    start = clock();
+    for( i=0; i<(size_t)sizes; ++i )
+    {
+        fonts[i] = texture_font_new( atlas, filenames[i%2], 8+2*i );
+        texture_font_load_glyphs( fonts[i], L"The quick brown fox" );
+    }
+    time = (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+    printf( "\n%d texture fonts created in %.3f ms\n", sizes, time );
+    for( i=0; i<font_registry_count( ); ++i )
+    {
+        file = font_registry_get( i );
+        printf( "%-20s %3d users, %d face, %7d bytes, %7d resident (%s)\n",
+                file->filename, (int) file->refcount,
+                (int) vector_size( file->faces ), (int) file->size,
+                (int) font_registry_resident( file ),
+                file->mapped ? "mapped" : "read" );
+        total += file->size;
+    }
+    printf( "Font bytes mapped: %d (%d with a mapping per font)\n",
+            (int) total, (int) (total * sizes / font_registry_count( )) );
+    for( i=0; i<(size_t)sizes; ++i )
+    {
+        texture_font_delete( fonts[i] );
+    }
+    texture_atlas_delete( atlas );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,158 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <time.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+#include "distance-field.h"
+
+#if defined(__APPLE__)
+    #include <Glut/glut.h>
+#elif defined(_WIN32) || defined(_WIN64)
+    #include <GLUT/glut.h>
+#else
+    #include <GL/glut.h>
+#endif
+
+
+// ------------------------------------------------------- global variables ---
+const char * filename = "fonts/Vera.ttf";
+const wchar_t * charset = L" !\"#$%&'()*+,-./0123456789:;<=>?"
+                          L"@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_"
+                          L"`abcdefghijklmnopqrstuvwxyz{|}~";
+
+
+// ------------------------------------------------------------------- load ---
+// Load the charset at each size in a bitmap atlas, or once at a given size
+// in a distance field atlas, reporting atlas bytes in use
+size_t load( const float * sizes, const size_t count, const int render_mode,
+             double * time )
+{
+    texture_atlas_t *atlas;
+    texture_font_t *font;
+    clock_t start = clock();
+    size_t i, used;
+
+    atlas = texture_atlas_new( 512, 512, 1 );
+    atlas->max_width = atlas->max_height = 4096;
+    for( i=0; i<count; ++i )
+    {
+        font = texture_font_new( atlas, filename, sizes[i] );
+        font->render_mode = render_mode;
+        texture_font_load_charset( font, charset );
+        texture_font_delete( font );
+    }
+    *time = (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+    used = atlas->used;
+    texture_atlas_delete( atlas );
+    return used;
+}
+
+
+// ------------------------------------------------------------------ grow ---
+// Time per glyph of adding the charset at one more size to a populated
+// 1024x1024 distance field atlas, and time of transforming that whole
+// atlas again as was done when glyphs were added as bitmaps
+double grow( double * whole, size_t * used )
+{
+    texture_atlas_t *atlas = texture_atlas_new( 1024, 1024, 1 );
+    texture_font_t *font;
+    unsigned char *map;
+    clock_t start;
+    double time;
+    float pt;
+
+    atlas->max_width = atlas->max_height = 1024;
+    for( pt=16; pt<=48; pt+=4 )
+    {
+        font = texture_font_new( atlas, filename, pt );
+        font->render_mode = TEXTURE_FONT_DISTANCE_FIELD;
+        texture_font_load_charset( font, charset );
+        texture_font_delete( font );
+    }
+    *used = atlas->used;
+
+    font = texture_font_new( atlas, filename, 34 );
+    font->render_mode = TEXTURE_FONT_DISTANCE_FIELD;
+    start = clock();
+    texture_font_load_charset( font, charset );
+    time = (clock() - start) * 1000.0 / CLOCKS_PER_SEC / wcslen( charset );
+    texture_font_delete( font );
+
+    start = clock();
+    map = make_distance_map( atlas->data, atlas->width, atlas->height,
+                             DISTANCE_FIELD_EDTAA3 );
+    *whole = (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+    free( map );
+    texture_atlas_delete( atlas );
+    return time;
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    float sizes[] = { 8, 10, 12, 14, 16, 18, 20, 24, 28, 32,
+                      36, 40, 48, 56, 64, 72 };
+    float base = 32;
+    size_t count = sizeof(sizes)/sizeof(float), used;
+    double time, whole;
+
+    glutInit( &argc, argv );
+    glutInitWindowSize( 100, 100 );
+    glutInitDisplayMode( GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH );
+    glutCreateWindow( "Freetype OpenGL distance field font benchmark" );
+
+    GLenum err = glewInit();
+    if (GLEW_OK != err)
+    {
+        /* Problem: glewInit failed, something is seriously wrong. */
+        fprintf( stderr, "Error: %s\n", glewGetErrorString(err) );
+        exit( EXIT_FAILURE );
+    }
+
+    printf( "%d characters of \"%s\", %d sizes from %.0f to %.0f\n",
+            (int) wcslen( charset ), filename, (int) count,
+            sizes[0], sizes[count-1] );
+    used = load( sizes, count, TEXTURE_FONT_BITMAP, &time );
+    printf( "Bitmaps, one set per size   : %8d bytes, %8.1f ms\n",
+            (int) used, time );
+    used = load( &base, 1, TEXTURE_FONT_DISTANCE_FIELD, &time );
+    printf( "Distance field at %.0f pixels : %8d bytes, %8.1f ms\n",
+            base, (int) used, time );
+    time = grow( &whole, &used );
+    printf( "One more glyph in a 1024x1024 atlas (%d bytes used): %.2f ms, "
+            "whole atlas transform: %.1f ms\n", (int) used, time, whole );
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+
+#if defined(__APPLE__)
+    #include <Glut/glut.h>
+#elif defined(_WIN32) || defined(_WIN64)
+    #include <GLUT/glut.h>
+#else
+    #include <GL/glut.h>
+#endif
+
+
+// ------------------------------------------------------- global variables ---
+const char * filename = "fonts/Vera.ttf";
+const int rounds = 5;
+wchar_t charset[1024];
+
+
+// ------------------------------------------------------------ make_charset ---
+// Latin (basic, latin-1, extended A & B), Greek and Cyrillic
+void make_charset( void )
+{
+    size_t count = 0;
+    wchar_t c;
+
+    for( c=0x20; c<0x250; ++c )
+    {
+        if( (c < 0x7f) || (c > 0x9f) )
+        {
+            charset[count++] = c;
+        }
+    }
+    for( c=0x370; c<0x500; ++c )
+    {
+        charset[count++] = c;
+    }
+    charset[count] = 0;
+}
+
+
+// -------------------------------------------------------------------- load ---
+// Cold start: a new font (and its worker faces) for each round
+double load( const float size, const int outline_type, const size_t threads )
+{
+    texture_atlas_t *atlas;
+    texture_font_t *font;
+    int i, start, elapsed = 0;
+
+    for( i=0; i<rounds; ++i )
+    {
+        atlas = texture_atlas_new( 1024, 1024, 1 );
+        start = glutGet( GLUT_ELAPSED_TIME );
+        font = texture_font_new( atlas, filename, size );
+        font->outline_type = outline_type;
+        font->outline_thickness = 1;
+        font->threads = threads;
+        texture_font_load_charset( font, charset );
+        elapsed += glutGet( GLUT_ELAPSED_TIME ) - start;
+        texture_font_delete( font );
+        texture_atlas_delete( atlas );
+    }
+    return elapsed / (double) rounds;
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    size_t threads, max_threads = 8;
+    float sizes[] = { 24, 48, 96 };
+    int outlines[] = { 0, 0, 1 };
+    double reference[3], time;
+    size_t i;
+
+    glutInit( &argc, argv );
+    glutInitWindowSize( 100, 100 );
+    glutInitDisplayMode( GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH );
+    glutCreateWindow( "Freetype OpenGL rasterization threads benchmark" );
+
+    GLenum err = glewInit();
+    if (GLEW_OK != err)
+    {
+        /* Problem: glewInit failed, something is seriously wrong. */
+        fprintf( stderr, "Error: %s\n", glewGetErrorString(err) );
+        exit( EXIT_FAILURE );
+    }
+    if( argc > 1 )
+    {
+        max_threads = atoi( argv[1] );
+    }
+    make_charset( );
+
+    printf( "Cold start loading of %d characters from \"%s\" (wall clock)\n",
+            (int) wcslen( charset ), filename );
+    printf( "%8s", "threads" );
+    for( i=0; i<3; ++i )
+    {
+        printf( "   %3.0fpt%-8s ms (speedup)", sizes[i],
+                outlines[i] ? " outline" : "" );
+    }
+    printf( "\n" );
+    for( threads=1; threads<=max_threads; threads*=2 )
+    {
+        printf( "%8d", (int) threads );
+        for( i=0; i<3; ++i )
+        {
+            time = load( sizes[i], outlines[i], threads );
+            if( threads == 1 )
+            {
+                reference[i] = time;
+            }
+            printf( "   %14.1f    (%5.2fx)", time,
+                    time > 0 ? reference[i]/time : 0.0 );
+        }
+        printf( "\n" );
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,174 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include "freetype-gl.h"
+
+
+// ------------------------------------------------------- global variables ---
+// Recording OpenGL stub: this program provides its own texture entry points
+// (taking precedence over the OpenGL library ones) that keep a copy of the
+// texture in memory and record upload calls. No GPU nor window is needed.
+unsigned char * texture = NULL;
+size_t texture_width = 0, texture_height = 0, texture_depth = 1;
+GLint unpack_row_length = 0, unpack_alignment = 4;
+size_t calls = 0, full_calls = 0, bytes = 0;
+
+
+// ------------------------------------------------------------ GL recorder ---
+void GLAPIENTRY glGenTextures( GLsizei n, GLuint *textures )
+{
+    textures[0] = 1;
+}
+
+void GLAPIENTRY glDeleteTextures( GLsizei n, const GLuint *textures )
+{
+}
+
+void GLAPIENTRY glBindTexture( GLenum target, GLuint id )
+{
+}
+
+void GLAPIENTRY glTexParameteri( GLenum target, GLenum name, GLint param )
+{
+}
+
+void GLAPIENTRY glGetIntegerv( GLenum name, GLint *params )
+{
+    if( name == GL_UNPACK_ALIGNMENT )
+    {
+        *params = unpack_alignment;
+    }
+    else if( name == GL_UNPACK_ROW_LENGTH )
+    {
+        *params = unpack_row_length;
+    }
+}
+
+void GLAPIENTRY glPixelStorei( GLenum name, GLint param )
+{
+    if( name == GL_UNPACK_ALIGNMENT )
+    {
+        unpack_alignment = param;
+    }
+    else if( name == GL_UNPACK_ROW_LENGTH )
+    {
+        unpack_row_length = param;
+    }
+}
+
+void GLAPIENTRY glTexImage2D( GLenum target, GLint level, GLint internal_format,
+                              GLsizei width, GLsizei height, GLint border,
+                              GLenum format, GLenum type, const GLvoid *data )
+{
+    texture_depth = (format == GL_ALPHA) ? 1 : ((format == GL_RGB) ? 3 : 4);
+    texture_width = width;
+    texture_height = height;
+    free( texture );
+    texture = (unsigned char *) malloc( width*height*texture_depth );
+    memcpy( texture, data, width*height*texture_depth );
+    calls++;
+    full_calls++;
+    bytes += width*height*texture_depth;
+}
+
+void GLAPIENTRY glTexSubImage2D( GLenum target, GLint level,
+                                 GLint x, GLint y, GLsizei width, GLsizei height,
+                                 GLenum format, GLenum type, const GLvoid *data )
+{
+    GLsizei i;
+    size_t row = unpack_row_length ? unpack_row_length : width;
+    size_t stride = row * texture_depth;
+
+    if( stride % unpack_alignment )
+    {
+        stride += unpack_alignment - stride % unpack_alignment;
+    }
+    for( i=0; i<height; ++i )
+    {
+        memcpy( texture + ((y+i)*texture_width + x)*texture_depth,
+                (const unsigned char *) data + i*stride, width*texture_depth );
+    }
+    calls++;
+    bytes += width*height*texture_depth;
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    size_t depth;
+    wchar_t charcode;
+
+    printf( "Uploads while rendering one new glyph per frame (fonts/Vera.ttf)\n" );
+    printf( "%6s %8s %14s %14s %14s\n",
+            "depth", "frames", "calls/frame", "bytes/frame", "full/frame" );
+
+    for( depth=1; depth<=3; depth+=2 )
+    {
+        size_t frames = 0;
+        texture_atlas_t * atlas = texture_atlas_new( 512, 512, depth );
+        texture_font_t * font = texture_font_new( atlas, "fonts/Vera.ttf", 16 );
+
+        texture_font_load_glyphs( font, L" " );
+        calls = full_calls = bytes = 0;
+
+        for( charcode=33; charcode<0x180; ++charcode )
+        {
+            if( (charcode >= 127) && (charcode < 160) )
+            {
+                continue;
+            }
+            texture_font_get_glyph( font, charcode );
+            frames++;
+        }
+
+        printf( "%6d %8d %14.2f %14.1f %14d\n", (int) depth, (int) frames,
+                calls / (float) frames, bytes / (float) frames,
+                (int)(atlas->width*atlas->height*depth) );
+
+        if( (texture_width != atlas->width) || (texture_height != atlas->height) ||
+            memcmp( texture, atlas->data, atlas->width*atlas->height*depth ) )
+        {
+            fprintf( stderr, "Uploaded texture differs from atlas data\n" );
+            return EXIT_FAILURE;
+        }
+
+        texture_font_delete( font );
+        texture_atlas_delete( atlas );
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -33,9 +33,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <wchar.h>
+#include <math.h>
 
 #include "freetype-gl.h"
-#include "edtaa3func.h"
 #include "font-manager.h"
 #include "vertex-buffer.h"
 #include "text-buffer.h"
@@ -185,78 +185,6 @@ add_text( vertex_buffer_t * buffer, texture_font_t * font,
 }
 
 
-// ------------------------------------------------------ make_distance_map ---
-unsigned char *
-make_distance_map( unsigned char *img,
-                   unsigned int width, unsigned int height )
-{
-    short * xdist = (short *)  malloc( width * height * sizeof(short) );
-    short * ydist = (short *)  malloc( width * height * sizeof(short) );
-    double * gx   = (double *) calloc( width * height, sizeof(double) );
-    double * gy      = (double *) calloc( width * height, sizeof(double) );
-    double * data    = (double *) calloc( width * height, sizeof(double) );
-    double * outside = (double *) calloc( width * height, sizeof(double) );
-    double * inside  = (double *) calloc( width * height, sizeof(double) );
-    int i;
-
-    // Convert img into double (data)
-    double img_min = 255, img_max = -255;
-    for( i=0; i<width*height; ++i)
-    {
-        double v = img[i];
-        data[i] = v;
-        if (v > img_max) img_max = v;
-        if (v < img_min) img_min = v;
-    }
-    // Rescale image levels between 0 and 1
-    for( i=0; i<width*height; ++i)
-    {
-        data[i] = (img[i]-img_min)/img_max;
-    }
-
-    // Compute outside = edtaa3(bitmap); % Transform background (0's)
-    computegradient( data, height, width, gx, gy);
-    edtaa3(data, gx, gy, height, width, xdist, ydist, outside);
-    for( i=0; i<width*height; ++i)
-        if( outside[i] < 0 )
-            outside[i] = 0.0;
-
-    // Compute inside = edtaa3(1-bitmap); % Transform foreground (1's)
-    memset(gx, 0, sizeof(double)*width*height );
-    memset(gy, 0, sizeof(double)*width*height );
-    for( i=0; i<width*height; ++i)
-        data[i] = 1 - data[i];
-    computegradient( data, height, width, gx, gy);
-    edtaa3(data, gx, gy, height, width, xdist, ydist, inside);
-    for( i=0; i<width*height; ++i)
-        if( inside[i] < 0 )
-            inside[i] = 0.0;
-
-    // distmap = outside - inside; % Bipolar distance field
-    unsigned char *out = (unsigned char *) malloc( width * height * sizeof(unsigned char) );
-    for( i=0; i<width*height; ++i)
-    {
-        outside[i] -= inside[i];
-        outside[i] = 128+outside[i]*16;
-        if( outside[i] < 0 ) outside[i] = 0;
-        if( outside[i] > 255 ) outside[i] = 255;
-        out[i] = 255 - (unsigned char) outside[i];
-        //out[i] = (unsigned char) outside[i];
-    }
-
-    free( xdist );
-    free( ydist );
-    free( gx );
-    free( gy );
-    free( data );
-    free( outside );
-    free( inside );
-    return out;
-}
-
-
-
-
 // ------------------------------------------------------------------- main ---
 int
 main( int argc, char **argv )
@@ -286,6 +214,8 @@ main( int argc, char **argv )
     vec2 pen = {{0,0}};
     vec4 black = {{1,1,1,1}};
     font = texture_font_new( atlas, filename, 48 );
+    font->render_mode = TEXTURE_FONT_DISTANCE_FIELD;
+    font->padding = 8;
     vec4 bbox = add_text( buffer, font, text, &black, &pen );
     size_t i;
     vector_t * vertices = buffer->vertices;
@@ -298,13 +228,6 @@ main( int argc, char **argv )
 
 
     glBindTexture( GL_TEXTURE_2D, atlas->id );
-
-    fprintf( stderr, "Generating distance map...\n" );
-    unsigned char *map = make_distance_map(atlas->data, atlas->width, atlas->height);
-    fprintf( stderr, "done !\n");
-
-    memcpy( atlas->data, map, atlas->width*atlas->height*sizeof(unsigned char) );
-    free(map);
     texture_atlas_upload( atlas );
 
     shader = shader_load( "shaders/distance-field-2.vert",
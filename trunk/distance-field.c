@@ -0,0 +1,930 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "platform.h"
+#include "vector.h"
+#include "vec234.h"
+#include "edtaa3func.h"
+#include "distance-field.h"
+
+
+// Squared distance of pixels with nothing to measure to
+#define DISTANCE_FIELD_INFINITY 1e20f
+
+
+// Transform of one of the two sides of make_distance_field
+typedef struct
+{
+    float * data;
+    size_t width, height;
+    float * gx;
+    float * gy;
+    short * xdist;
+    short * ydist;
+    float * dist;
+} distance_field_job_t;
+
+
+// ---------------------------------------------------- distance_field_edt ---
+// Distance of background pixels to shapes (0 inside), data being in [0,1]
+void
+distance_field_edt( void * data )
+{
+    distance_field_job_t *job = (distance_field_job_t *) data;
+    size_t i, n = job->width*job->height;
+
+    memset( job->gx, 0, n*sizeof(float) );
+    memset( job->gy, 0, n*sizeof(float) );
+    computegradientf( job->data, job->width, job->height, job->gx, job->gy );
+    edtaa3f( job->data, job->gx, job->gy, job->width, job->height,
+             job->xdist, job->ydist, job->dist );
+    for( i=0; i<n; ++i )
+    {
+        if( job->dist[i] < 0 )
+        {
+            job->dist[i] = 0.0f;
+        }
+    }
+}
+
+
+// -------------------------------------------------- distance_field_alloc ---
+void *
+distance_field_alloc( size_t size )
+{
+    void *p = malloc( size );
+    if( p == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    return p;
+}
+
+
+// ------------------------------------------------- distance_field_edtaa3 ---
+void
+distance_field_edtaa3( const unsigned char * img,
+                       unsigned char * out,
+                       size_t width,
+                       size_t height,
+                       double scale )
+{
+    size_t i, n = width*height;
+    distance_field_job_t outside, inside;
+    platform_thread_t thread;
+    int threaded = n >= DISTANCE_FIELD_THREADED_SIZE;
+    double v;
+
+    // Single precision transform (24 bytes per pixel, or 40 when both
+    // sides are transformed at once, instead of 44 in double precision)
+    outside.width = inside.width = width;
+    outside.height = inside.height = height;
+    outside.data  = (float *) distance_field_alloc( n * sizeof(float) );
+    outside.gx    = (float *) distance_field_alloc( n * sizeof(float) );
+    outside.gy    = (float *) distance_field_alloc( n * sizeof(float) );
+    outside.xdist = (short *) distance_field_alloc( n * sizeof(short) );
+    outside.ydist = (short *) distance_field_alloc( n * sizeof(short) );
+    outside.dist  = (float *) distance_field_alloc( n * sizeof(float) );
+    inside = outside;
+    inside.dist   = (float *) distance_field_alloc( n * sizeof(float) );
+    if( threaded )
+    {
+        inside.data  = (float *) distance_field_alloc( n * sizeof(float) );
+        inside.gx    = (float *) distance_field_alloc( n * sizeof(float) );
+        inside.gy    = (float *) distance_field_alloc( n * sizeof(float) );
+        inside.xdist = (short *) distance_field_alloc( n * sizeof(short) );
+        inside.ydist = (short *) distance_field_alloc( n * sizeof(short) );
+    }
+
+    // Transform background (0's), then foreground (1's), each in its own
+    // thread for large bitmaps (sweeps of edtaa3 can't be split)
+    for( i=0; i<n; ++i )
+    {
+        outside.data[i] = img[i] / 255.0f;
+    }
+    if( threaded )
+    {
+        for( i=0; i<n; ++i )
+        {
+            inside.data[i] = 1 - outside.data[i];
+        }
+        threaded = platform_thread_create( &thread, distance_field_edt,
+                                           &inside );
+    }
+    distance_field_edt( &outside );
+    if( threaded )
+    {
+        platform_thread_join( thread );
+    }
+    else
+    {
+        if( inside.data != outside.data )
+        {
+            // Thread could not be started
+            distance_field_edt( &inside );
+        }
+        else
+        {
+            for( i=0; i<n; ++i )
+            {
+                inside.data[i] = 1 - inside.data[i];
+            }
+            distance_field_edt( &inside );
+        }
+    }
+
+    // Bipolar distance field
+    for( i=0; i<n; ++i )
+    {
+        v = 128 + (inside.dist[i] - outside.dist[i])*scale;
+        out[i] = v < 0 ? 0 : (v > 255 ? 255 : (unsigned char) v);
+    }
+
+    if( inside.data != outside.data )
+    {
+        free( inside.data );
+        free( inside.gx );
+        free( inside.gy );
+        free( inside.xdist );
+        free( inside.ydist );
+    }
+    free( inside.dist );
+    free( outside.data );
+    free( outside.gx );
+    free( outside.gy );
+    free( outside.xdist );
+    free( outside.ydist );
+    free( outside.dist );
+}
+
+
+// Lines (rows or columns) of the two squared distance grids of
+// distance_field_exact transformed by one thread
+typedef struct
+{
+    float * grids[2];
+    size_t width, height;
+    size_t first, last;
+    int columns;
+} distance_field_pass_t;
+
+
+// --------------------------------------------------- distance_field_edt1d ---
+// Felzenszwalb & Huttenlocher 1D squared distance transform of f (n values)
+// into d, v and z being scratch arrays of n and n+1 values
+void
+distance_field_edt1d( const float * f, float * d, size_t * v, float * z,
+                      size_t n )
+{
+    size_t q, k = 0;
+    float s;
+
+    v[0] = 0;
+    z[0] = -DISTANCE_FIELD_INFINITY;
+    z[1] = +DISTANCE_FIELD_INFINITY;
+    for( q=1; q<n; ++q )
+    {
+        // Intersection of the parabola from q with the lowest envelope one
+        s = ((f[q] + q*(float)q) - (f[v[k]] + v[k]*(float)v[k]))
+          / (2.0f*q - 2.0f*v[k]);
+        while( s <= z[k] )
+        {
+            --k;
+            s = ((f[q] + q*(float)q) - (f[v[k]] + v[k]*(float)v[k]))
+              / (2.0f*q - 2.0f*v[k]);
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k+1] = +DISTANCE_FIELD_INFINITY;
+    }
+    for( q=0, k=0; q<n; ++q )
+    {
+        while( z[k+1] < q )
+        {
+            ++k;
+        }
+        d[q] = (q - (float)v[k])*(q - (float)v[k]) + f[v[k]];
+    }
+}
+
+
+// --------------------------------------------------- distance_field_pass ---
+void
+distance_field_pass( void * data )
+{
+    distance_field_pass_t *pass = (distance_field_pass_t *) data;
+    size_t n = pass->columns ? pass->height : pass->width;
+    size_t stride = pass->columns ? pass->width : 1;
+    size_t line_stride = pass->columns ? 1 : pass->width;
+    size_t i, j, line;
+    float *f = (float *) distance_field_alloc( n * sizeof(float) );
+    float *d = (float *) distance_field_alloc( n * sizeof(float) );
+    float *z = (float *) distance_field_alloc( (n+1) * sizeof(float) );
+    size_t *v = (size_t *) distance_field_alloc( n * sizeof(size_t) );
+    float *grid;
+
+    for( i=0; i<2; ++i )
+    {
+        for( line=pass->first; line<pass->last; ++line )
+        {
+            grid = pass->grids[i] + line*line_stride;
+            for( j=0; j<n; ++j )
+            {
+                f[j] = grid[j*stride];
+            }
+            distance_field_edt1d( f, d, v, z, n );
+            for( j=0; j<n; ++j )
+            {
+                grid[j*stride] = d[j];
+            }
+        }
+    }
+    free( f );
+    free( d );
+    free( z );
+    free( v );
+}
+
+
+// -------------------------------------------------- distance_field_exact ---
+void
+distance_field_exact( const unsigned char * img,
+                      unsigned char * out,
+                      size_t width,
+                      size_t height,
+                      double scale )
+{
+    size_t i, n = width*height, lines;
+    size_t threads = n >= DISTANCE_FIELD_THREADED_SIZE ?
+                     DISTANCE_FIELD_THREADS : 1;
+    distance_field_pass_t passes[DISTANCE_FIELD_THREADS];
+    platform_thread_t handles[DISTANCE_FIELD_THREADS];
+    size_t started;
+    float *to_shape, *to_background;
+    int columns;
+    double v;
+
+    // Squared distances of each pixel to the nearest shape pixel and to the
+    // nearest background pixel, shapes being pixels of at least 128
+    to_shape = (float *) distance_field_alloc( n * sizeof(float) );
+    to_background = (float *) distance_field_alloc( n * sizeof(float) );
+    for( i=0; i<n; ++i )
+    {
+        to_shape[i] = img[i] < 128 ? DISTANCE_FIELD_INFINITY : 0;
+        to_background[i] = img[i] < 128 ? 0 : DISTANCE_FIELD_INFINITY;
+    }
+
+    // Separable transform: columns then rows, lines of each pass being
+    // shared between threads
+    for( columns=1; columns>=0; --columns )
+    {
+        lines = columns ? width : height;
+        for( i=0; i<threads; ++i )
+        {
+            passes[i].grids[0] = to_shape;
+            passes[i].grids[1] = to_background;
+            passes[i].width = width;
+            passes[i].height = height;
+            passes[i].first = lines*i/threads;
+            passes[i].last = lines*(i+1)/threads;
+            passes[i].columns = columns;
+        }
+        for( started=1; started<threads; ++started )
+        {
+            if( !platform_thread_create( handles + started,
+                                         distance_field_pass,
+                                         passes + started ) )
+            {
+                break;
+            }
+        }
+        // Calling thread also takes over threads that could not be started
+        distance_field_pass( passes );
+        for( i=started; i<threads; ++i )
+        {
+            distance_field_pass( passes + i );
+        }
+        for( i=1; i<started; ++i )
+        {
+            platform_thread_join( handles[i] );
+        }
+    }
+
+    // Edge is half a pixel away from the centers of the pixels on its sides
+    for( i=0; i<n; ++i )
+    {
+        if( img[i] < 128 )
+        {
+            v = 128 - (sqrt( to_shape[i] ) - 0.5)*scale;
+        }
+        else
+        {
+            v = 128 + (sqrt( to_background[i] ) - 0.5)*scale;
+        }
+        out[i] = v < 0 ? 0 : (v > 255 ? 255 : (unsigned char) v);
+    }
+    free( to_shape );
+    free( to_background );
+}
+
+
+// --------------------------------------------------- make_distance_field ---
+void
+make_distance_field( const unsigned char * img,
+                     unsigned char * out,
+                     size_t width,
+                     size_t height,
+                     double scale,
+                     int engine )
+{
+    assert( img );
+    assert( out );
+
+    if( engine == DISTANCE_FIELD_EXACT )
+    {
+        distance_field_exact( img, out, width, height, scale );
+    }
+    else
+    {
+        distance_field_edtaa3( img, out, width, height, scale );
+    }
+}
+
+
+// ----------------------------------------------------- make_distance_map ---
+unsigned char *
+make_distance_map( unsigned char * img,
+                   unsigned int width,
+                   unsigned int height,
+                   int engine )
+{
+    unsigned char img_min = 255, img_max = 0;
+    unsigned char *out;
+    size_t i;
+
+    out = (unsigned char *) malloc( width * height * sizeof(unsigned char) );
+    if( out == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+
+    // Rescale image levels between 0 and 255
+    for( i=0; i<width*height; ++i )
+    {
+        img_min = img[i] < img_min ? img[i] : img_min;
+        img_max = img[i] > img_max ? img[i] : img_max;
+    }
+    for( i=0; i<width*height; ++i )
+    {
+        out[i] = img_max > img_min ?
+            (unsigned char)( (img[i]-img_min) * 255 / (img_max-img_min) ) : 0;
+    }
+    make_distance_field( out, out, width, height, 16, engine );
+    return out;
+}
+
+
+// Channels an outline edge is in, in multi-channel distance fields
+#define DISTANCE_FIELD_RED     1
+#define DISTANCE_FIELD_GREEN   2
+#define DISTANCE_FIELD_BLUE    4
+#define DISTANCE_FIELD_CYAN    (DISTANCE_FIELD_GREEN | DISTANCE_FIELD_BLUE)
+#define DISTANCE_FIELD_MAGENTA (DISTANCE_FIELD_RED | DISTANCE_FIELD_BLUE)
+#define DISTANCE_FIELD_YELLOW  (DISTANCE_FIELD_RED | DISTANCE_FIELD_GREEN)
+#define DISTANCE_FIELD_WHITE   (DISTANCE_FIELD_RED | DISTANCE_FIELD_GREEN | \
+                                DISTANCE_FIELD_BLUE)
+
+// Segments outline curves are flattened into
+#define DISTANCE_FIELD_CURVE_STEPS 8
+
+// Sine of the smallest change of direction between two edges making a
+// corner (about 8 degrees)
+#define DISTANCE_FIELD_CORNER 0.1411f
+
+
+// Outline edge (a line or a flattened curve) of a multi-channel field
+typedef struct
+{
+    size_t first, last;
+    int color;
+} distance_field_edge_t;
+
+
+// Outline being decomposed into edges by FT_Outline_Decompose
+typedef struct
+{
+    vector_t * points;
+    vector_t * edges;
+    size_t contour;
+    vec2 position;
+} distance_field_shape_t;
+
+
+// Distance of a pixel to an edge (see distance_field_edge_distance)
+typedef struct
+{
+    float distance;
+    float dot;
+    float pseudo;
+} distance_field_distance_t;
+
+
+// ---------------------------------------------- distance_field_add_edge ---
+// Add an edge going through count points, unless it has no length
+void
+distance_field_add_edge( distance_field_shape_t * shape,
+                         const vec2 * points,
+                         size_t count )
+{
+    distance_field_edge_t edge;
+    size_t i;
+
+    edge.first = vector_size( shape->points );
+    edge.color = DISTANCE_FIELD_WHITE;
+    vector_push_back( shape->points, points );
+    for( i=1; i<count; ++i )
+    {
+        if( (points[i].x != points[i-1].x) || (points[i].y != points[i-1].y) )
+        {
+            vector_push_back( shape->points, points + i );
+        }
+    }
+    edge.last = vector_size( shape->points ) - 1;
+    if( edge.last == edge.first )
+    {
+        vector_pop_back( shape->points );
+        return;
+    }
+    vector_push_back( shape->edges, &edge );
+}
+
+
+// ---------------------------------------------- distance_field_direction ---
+// Unit direction of an edge at its start, or at its end
+vec2
+distance_field_direction( const distance_field_shape_t * shape,
+                          const distance_field_edge_t * edge,
+                          int end )
+{
+    size_t i = end ? edge->last - 1 : edge->first;
+    const vec2 *a = (const vec2 *) vector_get( shape->points, i );
+    const vec2 *b = (const vec2 *) vector_get( shape->points, i+1 );
+    vec2 direction;
+    float length;
+
+    direction.x = b->x - a->x;
+    direction.y = b->y - a->y;
+    length = sqrtf( direction.x*direction.x + direction.y*direction.y );
+    direction.x /= length;
+    direction.y /= length;
+    return direction;
+}
+
+
+// ------------------------------------------ distance_field_split_contour ---
+// Split each edge of the current contour in three, for the contour to be
+// colored with three colors
+void
+distance_field_split_contour( distance_field_shape_t * shape )
+{
+    size_t i, j, part, segments, count, first = shape->contour;
+    size_t edges = vector_size( shape->edges ) - first;
+    distance_field_edge_t *copy;
+    const vec2 *a, *b;
+    vec2 *points;
+    float t;
+
+    copy = (distance_field_edge_t *)
+        distance_field_alloc( edges*sizeof(distance_field_edge_t) );
+    memcpy( copy, vector_get( shape->edges, first ),
+            edges*sizeof(distance_field_edge_t) );
+    vector_resize( shape->edges, first );
+    for( i=0; i<edges; ++i )
+    {
+        // Edges of less than three segments get each segment split in three
+        count = copy[i].last - copy[i].first;
+        segments = count >= 3 ? count : 3*count;
+        points = (vec2 *) distance_field_alloc( (segments+1)*sizeof(vec2) );
+        for( j=0; j<=segments; ++j )
+        {
+            if( (count >= 3) || (j%3 == 0) )
+            {
+                points[j] = *(const vec2 *) vector_get( shape->points,
+                    copy[i].first + (count >= 3 ? j : j/3) );
+            }
+            else
+            {
+                a = (const vec2 *) vector_get( shape->points,
+                                               copy[i].first + j/3 );
+                b = (const vec2 *) vector_get( shape->points,
+                                               copy[i].first + j/3 + 1 );
+                t = (j%3) / 3.0f;
+                points[j].x = a->x + t*(b->x - a->x);
+                points[j].y = a->y + t*(b->y - a->y);
+            }
+        }
+        for( part=0; part<3; ++part )
+        {
+            distance_field_add_edge( shape, points + part*segments/3,
+                                     (part+1)*segments/3 - part*segments/3 + 1 );
+        }
+        free( points );
+    }
+    free( copy );
+}
+
+
+// ------------------------------------------ distance_field_color_contour ---
+// Color the edges of the current contour so that edges meeting at a corner
+// share a single channel, smooth contours being white
+void
+distance_field_color_contour( distance_field_shape_t * shape )
+{
+    int colors[3] = { DISTANCE_FIELD_CYAN, DISTANCE_FIELD_MAGENTA,
+                      DISTANCE_FIELD_YELLOW };
+    size_t i, index, count, corners = 0, spline = 0, first = shape->contour;
+    distance_field_edge_t *edge, *previous;
+    size_t *corner;
+    vec2 a, b;
+    int position;
+
+    count = vector_size( shape->edges ) - first;
+    if( count == 0 )
+    {
+        return;
+    }
+    corner = (size_t *) distance_field_alloc( count*sizeof(size_t) );
+    for( i=0; i<count; ++i )
+    {
+        previous = (distance_field_edge_t *)
+            vector_get( shape->edges, first + (i+count-1)%count );
+        edge = (distance_field_edge_t *) vector_get( shape->edges, first+i );
+        a = distance_field_direction( shape, previous, 1 );
+        b = distance_field_direction( shape, edge, 0 );
+        if( (a.x*b.x + a.y*b.y <= 0) ||
+            (fabsf( a.x*b.y - a.y*b.x ) > DISTANCE_FIELD_CORNER) )
+        {
+            corner[corners++] = i;
+        }
+    }
+
+    if( corners == 1 )
+    {
+        // Teardrop: both sides of the corner and the middle of the contour
+        // get a different color
+        colors[0] = DISTANCE_FIELD_MAGENTA;
+        colors[1] = DISTANCE_FIELD_WHITE;
+        colors[2] = DISTANCE_FIELD_YELLOW;
+        if( count < 3 )
+        {
+            distance_field_split_contour( shape );
+            count *= 3;
+            corner[0] *= 3;
+        }
+        for( i=0; i<count; ++i )
+        {
+            edge = (distance_field_edge_t *)
+                vector_get( shape->edges, first + (corner[0]+i)%count );
+            position = (int)( 3 + 2.875*i/(count-1) - 1.4375 + .5 ) - 3;
+            edge->color = colors[1 + position];
+        }
+    }
+    else if( corners > 1 )
+    {
+        // Edges between two corners (splines) cycle through three colors,
+        // the last one differing from both its neighbours
+        for( i=0; i<count; ++i )
+        {
+            index = (corner[0]+i)%count;
+            if( (spline+1 < corners) && (corner[spline+1] == index) )
+            {
+                ++spline;
+            }
+            edge = (distance_field_edge_t *)
+                vector_get( shape->edges, first + index );
+            if( (spline == corners-1) && (spline%3 == 0) )
+            {
+                edge->color = DISTANCE_FIELD_MAGENTA;
+            }
+            else
+            {
+                edge->color = colors[spline%3];
+            }
+        }
+    }
+    free( corner );
+}
+
+
+// ------------------------------------------------ distance_field_move_to ---
+int
+distance_field_move_to( const FT_Vector * to, void * user )
+{
+    distance_field_shape_t *shape = (distance_field_shape_t *) user;
+
+    distance_field_color_contour( shape );
+    shape->contour = vector_size( shape->edges );
+    shape->position.x = to->x / 64.0f;
+    shape->position.y = to->y / 64.0f;
+    return 0;
+}
+
+
+// ------------------------------------------------ distance_field_line_to ---
+int
+distance_field_line_to( const FT_Vector * to, void * user )
+{
+    distance_field_shape_t *shape = (distance_field_shape_t *) user;
+    vec2 points[2];
+
+    points[0] = shape->position;
+    points[1].x = to->x / 64.0f;
+    points[1].y = to->y / 64.0f;
+    distance_field_add_edge( shape, points, 2 );
+    shape->position = points[1];
+    return 0;
+}
+
+
+// ----------------------------------------------- distance_field_conic_to ---
+int
+distance_field_conic_to( const FT_Vector * control, const FT_Vector * to,
+                         void * user )
+{
+    distance_field_shape_t *shape = (distance_field_shape_t *) user;
+    vec2 points[DISTANCE_FIELD_CURVE_STEPS+1], p0 = shape->position, p1, p2;
+    float t, u;
+    size_t i;
+
+    p1.x = control->x / 64.0f;
+    p1.y = control->y / 64.0f;
+    p2.x = to->x / 64.0f;
+    p2.y = to->y / 64.0f;
+    for( i=0; i<=DISTANCE_FIELD_CURVE_STEPS; ++i )
+    {
+        t = i / (float) DISTANCE_FIELD_CURVE_STEPS;
+        u = 1 - t;
+        points[i].x = u*u*p0.x + 2*u*t*p1.x + t*t*p2.x;
+        points[i].y = u*u*p0.y + 2*u*t*p1.y + t*t*p2.y;
+    }
+    distance_field_add_edge( shape, points, DISTANCE_FIELD_CURVE_STEPS+1 );
+    shape->position = p2;
+    return 0;
+}
+
+
+// ----------------------------------------------- distance_field_cubic_to ---
+int
+distance_field_cubic_to( const FT_Vector * control1,
+                         const FT_Vector * control2,
+                         const FT_Vector * to,
+                         void * user )
+{
+    distance_field_shape_t *shape = (distance_field_shape_t *) user;
+    vec2 points[DISTANCE_FIELD_CURVE_STEPS+1], p0 = shape->position, p1, p2, p3;
+    float t, u;
+    size_t i;
+
+    p1.x = control1->x / 64.0f;
+    p1.y = control1->y / 64.0f;
+    p2.x = control2->x / 64.0f;
+    p2.y = control2->y / 64.0f;
+    p3.x = to->x / 64.0f;
+    p3.y = to->y / 64.0f;
+    for( i=0; i<=DISTANCE_FIELD_CURVE_STEPS; ++i )
+    {
+        t = i / (float) DISTANCE_FIELD_CURVE_STEPS;
+        u = 1 - t;
+        points[i].x = u*u*u*p0.x + 3*u*u*t*p1.x + 3*u*t*t*p2.x + t*t*t*p3.x;
+        points[i].y = u*u*u*p0.y + 3*u*u*t*p1.y + 3*u*t*t*p2.y + t*t*t*p3.y;
+    }
+    distance_field_add_edge( shape, points, DISTANCE_FIELD_CURVE_STEPS+1 );
+    shape->position = p3;
+    return 0;
+}
+
+
+// ----------------------------------------- distance_field_edge_distance ---
+// Signed distance (positive inside) of point p to an edge, orthogonality of
+// the edge at the nearest point (0 when perpendicular, to break ties at
+// shared ends) and pseudo-distance (ends of the edge being extended along
+// their direction), fill being on the right of edges when orientation is 1
+distance_field_distance_t
+distance_field_edge_distance( const distance_field_shape_t * shape,
+                              const distance_field_edge_t * edge,
+                              vec2 p, float orientation )
+{
+    distance_field_distance_t result;
+    const vec2 *points = (const vec2 *) vector_get( shape->points, 0 );
+    float dx, dy, qx, qy, t, d2, length, dot, cross;
+    float best = DISTANCE_FIELD_INFINITY, best_dot = 1, best_t = 0;
+    size_t i, nearest = edge->first;
+
+    for( i=edge->first; i<edge->last; ++i )
+    {
+        dx = points[i+1].x - points[i].x;
+        dy = points[i+1].y - points[i].y;
+        t = ((p.x - points[i].x)*dx + (p.y - points[i].y)*dy) / (dx*dx + dy*dy);
+        qx = p.x - (points[i].x + (t < 0 ? 0 : (t > 1 ? 1 : t))*dx);
+        qy = p.y - (points[i].y + (t < 0 ? 0 : (t > 1 ? 1 : t))*dy);
+        d2 = qx*qx + qy*qy;
+        dot = 0;
+        if( ((t < 0) || (t > 1)) && (d2 > 0) )
+        {
+            dot = fabsf( dx*qx + dy*qy ) / sqrtf( (dx*dx + dy*dy)*d2 );
+        }
+        if( (d2 < best) || ((d2 == best) && (dot < best_dot)) )
+        {
+            best = d2;
+            best_dot = dot;
+            best_t = t;
+            nearest = i;
+        }
+    }
+
+    dx = points[nearest+1].x - points[nearest].x;
+    dy = points[nearest+1].y - points[nearest].y;
+    cross = dx*(p.y - points[nearest].y) - dy*(p.x - points[nearest].x);
+    result.distance = cross*orientation < 0 ? sqrtf( best ) : -sqrtf( best );
+    result.dot = best_dot;
+    result.pseudo = result.distance;
+    if( ((nearest == edge->first) && (best_t < 0)) ||
+        ((nearest == edge->last-1) && (best_t > 1)) )
+    {
+        length = sqrtf( dx*dx + dy*dy );
+        result.pseudo = cross*orientation < 0 ? fabsf( cross/length )
+                                               : -fabsf( cross/length );
+    }
+    return result;
+}
+
+
+// ----------------------------------------------- distance_field_winding ---
+// Winding number of the outline around point p
+int
+distance_field_winding( const distance_field_shape_t * shape, vec2 p )
+{
+    const vec2 *points = (const vec2 *) vector_get( shape->points, 0 );
+    const distance_field_edge_t *edge;
+    size_t i, j;
+    int winding = 0;
+
+    for( i=0; i<vector_size( shape->edges ); ++i )
+    {
+        edge = (const distance_field_edge_t *) vector_get( shape->edges, i );
+        for( j=edge->first; j<edge->last; ++j )
+        {
+            if( ((points[j].y <= p.y) != (points[j+1].y <= p.y)) &&
+                (points[j].x + (p.y - points[j].y)
+                 * (points[j+1].x - points[j].x)
+                 / (points[j+1].y - points[j].y) > p.x) )
+            {
+                winding += points[j+1].y > points[j].y ? 1 : -1;
+            }
+        }
+    }
+    return winding;
+}
+
+
+// -------------------------------------------- make_multi_distance_field ---
+void
+make_multi_distance_field( const FT_Outline * outline,
+                           unsigned char * out,
+                           size_t width,
+                           size_t height,
+                           double left,
+                           double top,
+                           double scale )
+{
+    FT_Outline_Funcs funcs;
+    distance_field_shape_t shape;
+    distance_field_distance_t best[4], d;
+    const distance_field_edge_t *edge;
+    size_t x, y, i, c, edges;
+    float orientation, value, median, r, g, b;
+    int inside;
+    vec2 p;
+
+    assert( outline );
+    assert( out );
+
+    funcs.move_to = distance_field_move_to;
+    funcs.line_to = distance_field_line_to;
+    funcs.conic_to = distance_field_conic_to;
+    funcs.cubic_to = distance_field_cubic_to;
+    funcs.shift = 0;
+    funcs.delta = 0;
+    shape.points = vector_new( sizeof(vec2) );
+    shape.edges = vector_new( sizeof(distance_field_edge_t) );
+    shape.contour = 0;
+    shape.position.x = shape.position.y = 0;
+    FT_Outline_Decompose( (FT_Outline *) outline, &funcs, &shape );
+    distance_field_color_contour( &shape );
+    edges = vector_size( shape.edges );
+
+    // TrueType outlines are filled on the right of their contours,
+    // PostScript ones on the left
+    orientation = FT_Outline_Get_Orientation( (FT_Outline *) outline ) ==
+                  FT_ORIENTATION_POSTSCRIPT ? -1.0f : 1.0f;
+
+    for( y=0; y<height; ++y )
+    {
+        for( x=0; x<width; ++x )
+        {
+            p.x = (float)( left + x + 0.5 );
+            p.y = (float)( top - y - 0.5 );
+
+            // Nearest edge of each channel, and nearest edge at all
+            for( c=0; c<4; ++c )
+            {
+                best[c].distance = -DISTANCE_FIELD_INFINITY;
+                best[c].dot = 1;
+                best[c].pseudo = -DISTANCE_FIELD_INFINITY;
+            }
+            for( i=0; i<edges; ++i )
+            {
+                edge = (const distance_field_edge_t *)
+                    vector_get( shape.edges, i );
+                d = distance_field_edge_distance( &shape, edge, p,
+                                                  orientation );
+                for( c=0; c<4; ++c )
+                {
+                    if( ((c == 3) || (edge->color & (1 << c))) &&
+                        ((fabsf( d.distance ) < fabsf( best[c].distance )) ||
+                         ((fabsf( d.distance ) == fabsf( best[c].distance )) &&
+                          (d.dot < best[c].dot))) )
+                    {
+                        best[c] = d;
+                    }
+                }
+            }
+
+            // Pixels where the median of the channels is on the wrong side
+            // of the outline (clashing edges, overlapping contours) get the
+            // distance to the nearest edge, on the side given by the fill rule
+            inside = distance_field_winding( &shape, p );
+            if( outline->flags & FT_OUTLINE_EVEN_ODD_FILL )
+            {
+                inside &= 1;
+            }
+            r = best[0].pseudo;
+            g = best[1].pseudo;
+            b = best[2].pseudo;
+            median = r < g ? (g < b ? g : (r < b ? b : r))
+                           : (r < b ? r : (g < b ? b : g));
+            if( (median > 0) != (inside != 0) )
+            {
+                r = g = b = inside ? fabsf( best[3].distance )
+                                   : -fabsf( best[3].distance );
+            }
+            for( c=0; c<3; ++c )
+            {
+                value = (float)( 128 + (c == 0 ? r : (c == 1 ? g : b))*scale );
+                out[(y*width + x)*3 + c] = value < 0 ? 0 :
+                    (value > 255 ? 255 : (unsigned char) value);
+            }
+        }
+    }
+    vector_delete( shape.points );
+    vector_delete( shape.edges );
+}
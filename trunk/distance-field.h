@@ -0,0 +1,170 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#ifndef __DISTANCE_FIELD_H__
+#define __DISTANCE_FIELD_H__
+
+#include <stdlib.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_OUTLINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @file   distance-field.h
+ *
+ * @defgroup distance-field Distance field
+ *
+ * Signed distance fields of anti-aliased bitmaps, as used by the
+ * distance-field shaders: a value of 128 is on the edge of a shape, higher
+ * values are inside and lower ones outside.
+ *
+ * Texture fonts compute the field of each glyph as it is added (see
+ * TEXTURE_FONT_DISTANCE_FIELD), which costs the area of the glyph only.
+ * make_distance_map transforms a whole bitmap at once.
+ *
+ * <b>Example Usage</b>:
+ * @code
+ * #include "distance-field.h"
+ *
+ * int main( int arrgc, char *argv[] )
+ * {
+ *     unsigned char *map = make_distance_map( atlas->data,
+ *                                             atlas->width, atlas->height,
+ *                                             DISTANCE_FIELD_EDTAA3 );
+ *     memcpy( atlas->data, map, atlas->width*atlas->height );
+ *     free( map );
+ *
+ *     return 0;
+ * }
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Distance transform engines (see make_distance_field)
+ */
+/** Anti-aliased Euclidean distance transform (edtaa3), the edge being
+ *  located within pixels from their levels (default) */
+#define DISTANCE_FIELD_EDTAA3 0
+/** Exact Euclidean distance transform of the bitmap thresholded at 128
+ *  (Felzenszwalb & Huttenlocher), faster and split among threads but
+ *  with the edge always between pixels */
+#define DISTANCE_FIELD_EXACT  1
+
+
+/**
+ * Number of pixels from which distance fields are computed in several
+ * threads (two with DISTANCE_FIELD_EDTAA3)
+ */
+#define DISTANCE_FIELD_THREADED_SIZE 65536
+
+
+/**
+ * Number of threads of DISTANCE_FIELD_EXACT for large bitmaps
+ */
+#define DISTANCE_FIELD_THREADS 4
+
+
+/**
+ * Compute the signed distance field of a bitmap.
+ *
+ * @param img    bitmap (one byte per pixel, 255 inside shapes)
+ * @param out    distance field (same size as img, may be img)
+ * @param width  bitmap width
+ * @param height bitmap height
+ * @param scale  change of value per pixel of distance
+ * @param engine DISTANCE_FIELD_EDTAA3 or DISTANCE_FIELD_EXACT
+ */
+  void
+  make_distance_field( const unsigned char * img,
+                       unsigned char * out,
+                       size_t width,
+                       size_t height,
+                       double scale,
+                       int engine );
+
+
+/**
+ * Compute the distance map of a whole bitmap (e.g. atlas data), levels of
+ * the bitmap being rescaled first. Distance is encoded with 16 levels per
+ * pixel.
+ *
+ * @param img    bitmap (one byte per pixel)
+ * @param width  bitmap width
+ * @param height bitmap height
+ * @param engine DISTANCE_FIELD_EDTAA3 or DISTANCE_FIELD_EXACT
+ *
+ * @return a new bitmap (to be freed) holding the distance map
+ */
+  unsigned char *
+  make_distance_map( unsigned char * img,
+                     unsigned int width,
+                     unsigned int height,
+                     int engine );
+
+/**
+ * Compute the multi-channel signed distance field of a glyph outline: its
+ * edges are split at corners and given channels so that the median of the
+ * three channels keeps corners sharp (see shaders/distance-field-4.frag).
+ *
+ * @param outline outline (26.6 pixel coordinates, y going up)
+ * @param out     distance field (width*height*3 bytes)
+ * @param width   field width
+ * @param height  field height
+ * @param left    outline coordinate of the left side of the field
+ * @param top     outline coordinate of the top side of the field
+ * @param scale   change of value per pixel of distance
+ */
+  void
+  make_multi_distance_field( const FT_Outline * outline,
+                             unsigned char * out,
+                             size_t width,
+                             size_t height,
+                             double left,
+                             double top,
+                             double scale );
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __DISTANCE_FIELD_H__ */
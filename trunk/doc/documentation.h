@@ -78,6 +78,21 @@ font and pack glyphs into a texture.
   The texture-font structure is in charge of creating bitmap glyphs and to
   upload them to a texture atlas.
 
+- @ref font-registry<br/>
+  Font files mapped in memory once and shared by all the texture fonts.
+
+- @ref font-metrics<br/>
+  Glyph advances, bearings, kerning and text extents for layout, without
+  rasterization, texture atlas or OpenGL context.
+
+- @ref font-cache<br/>
+  Binary files written by makefont holding a font and its atlas, mapped in
+  memory and used in place at startup without freetype.
+
+- @ref distance-field<br/>
+  Signed distance fields (single or multi-channel) of glyphs or whole
+  atlases.
+
 
 @subsection optional Optional
 
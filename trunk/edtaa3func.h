@@ -92,6 +92,20 @@ double distaa3(double *img, double *gximg, double *gyimg, int w, int c, int xc,
 
 void edtaa3(double *img, double *gx, double *gy, int w, int h, short *distx, short *disty, double *dist);
 
+/*
+ * Single precision versions of the functions above (see edtaa3funcf.c).
+ * Distances differ from the double precision ones by a few thousandths
+ * of a pixel near shapes. They use about half the memory and run at
+ * about the same speed.
+ */
+void computegradientf(float *img, int w, int h, float *gx, float *gy);
+
+float edgedff(float gx, float gy, float a);
+
+float distaa3f(float *img, float *gximg, float *gyimg, int w, int c, int xc, int yc, int xi, int yi);
+
+void edtaa3f(float *img, float *gx, float *gy, int w, int h, short *distx, short *disty, float *dist);
+
 
 #ifdef __cplusplus
 }
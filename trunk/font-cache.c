@@ -0,0 +1,457 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <wchar.h>
+#include "platform.h"
+#include "vector.h"
+#include "texture-atlas.h"
+#include "texture-font.h"
+#include "font-cache.h"
+
+
+// ------------------------------------------------------- font_cache_align ---
+uint64_t
+font_cache_align( uint64_t offset )
+{
+    uint64_t mask = FONT_CACHE_ALIGNMENT-1;
+
+    return (offset + mask) & ~mask;
+}
+
+
+// ------------------------------------------------------- font_cache_write ---
+// Write a section at its offset, padding the file up to it
+int
+font_cache_write( FILE * file,
+                  const void * data,
+                  const size_t size,
+                  const uint32_t offset )
+{
+    static const char zeros[FONT_CACHE_ALIGNMENT] = { 0 };
+    long position = ftell( file );
+    size_t pad;
+
+    if( (position < 0) || ((size_t) position > offset) )
+    {
+        return 0;
+    }
+    // Sections are aligned and written in order, padding is below alignment
+    pad = offset - (size_t) position;
+    if( (pad > sizeof(zeros)) || (fwrite( zeros, 1, pad, file ) != pad) )
+    {
+        return 0;
+    }
+    return !size || (fwrite( data, 1, size, file ) == size);
+}
+
+
+// -------------------------------------------------------- font_cache_save ---
+int
+font_cache_save( texture_font_t * font,
+                 const char * filename )
+{
+    texture_atlas_t *atlas;
+    kerning_table_t *table;
+    texture_glyph_t *glyph;
+    font_cache_header_t header;
+    font_cache_glyph_t *glyphs;
+    font_cache_pair_t *pairs;
+    uint64_t end;
+    size_t i, count, pair_count, data_size;
+    FILE *file;
+    int ok;
+
+    assert( font );
+    assert( filename );
+
+    atlas = font->atlas;
+    table = font->kerning_table;
+    data_size = atlas->page_count*atlas->width*atlas->height*atlas->depth;
+
+    glyphs = (font_cache_glyph_t *)
+        calloc( vector_size( font->glyphs ) + 1, sizeof(font_cache_glyph_t) );
+    pairs = (font_cache_pair_t *)
+        calloc( table->count + 1, sizeof(font_cache_pair_t) );
+    if( (glyphs == NULL) || (pairs == NULL) )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    for( i=0, count=0; i<vector_size( font->glyphs ); ++i )
+    {
+        glyph = *(texture_glyph_t **) vector_get( font->glyphs, i );
+        if( glyph->pending )
+        {
+            continue;
+        }
+        glyphs[count].charcode = (uint32_t) glyph->charcode;
+        glyphs[count].glyph_index = glyph->glyph_index;
+        glyphs[count].width = (uint32_t) glyph->width;
+        glyphs[count].height = (uint32_t) glyph->height;
+        glyphs[count].offset_x = glyph->offset_x;
+        glyphs[count].offset_y = glyph->offset_y;
+        glyphs[count].advance_x = glyph->advance_x;
+        glyphs[count].advance_y = glyph->advance_y;
+        glyphs[count].s0 = glyph->s0;
+        glyphs[count].t0 = glyph->t0;
+        glyphs[count].s1 = glyph->s1;
+        glyphs[count].t1 = glyph->t1;
+        glyphs[count].page = (uint32_t) glyph->page;
+        glyphs[count].outline_type = glyph->outline_type;
+        glyphs[count].outline_thickness = glyph->outline_thickness;
+        glyphs[count].phase = glyph->phase;
+        count++;
+    }
+    for( i=0, pair_count=0; i<table->capacity; ++i )
+    {
+        if( table->pairs[i].kerning &&
+            (table->pairs[i].kerning != KERNING_WIDE) )
+        {
+            pairs[pair_count].left = table->pairs[i].left;
+            pairs[pair_count].right = table->pairs[i].right;
+            pairs[pair_count].kerning = table->pairs[i].kerning
+                                      / (float) KERNING_SCALE;
+            pair_count++;
+        }
+    }
+    for( i=0; i<vector_size( table->wide ); ++i )
+    {
+        kerning_wide_pair_t *wide =
+            (kerning_wide_pair_t *) vector_get( table->wide, i );
+        pairs[pair_count].left = (uint32_t) wide->left;
+        pairs[pair_count].right = (uint32_t) wide->right;
+        pairs[pair_count].kerning = wide->kerning;
+        pair_count++;
+    }
+
+    memset( &header, 0, sizeof(header) );
+    memcpy( header.magic, FONT_CACHE_MAGIC, sizeof(header.magic) );
+    header.version = FONT_CACHE_VERSION;
+    header.byte_order = FONT_CACHE_BYTE_ORDER;
+    header.header_size = sizeof(font_cache_header_t);
+    header.size = font->size;
+    header.height = font->height;
+    header.linegap = font->linegap;
+    header.ascender = font->ascender;
+    header.descender = font->descender;
+    header.underline_position = font->underline_position;
+    header.underline_thickness = font->underline_thickness;
+    header.hinting = font->hinting;
+    header.kerning = font->kerning;
+    header.outline_type = font->outline_type;
+    header.outline_thickness = font->outline_thickness;
+    header.render_mode = font->render_mode;
+    header.padding = (uint32_t) font->padding;
+    header.subpixel_phases = (uint32_t) font->subpixel_phases;
+    header.phase = font->phase;
+    header.width = (uint32_t) atlas->width;
+    header.atlas_height = (uint32_t) atlas->height;
+    header.depth = (uint32_t) atlas->depth;
+    header.page_count = (uint32_t) atlas->page_count;
+    header.max_pages = (uint32_t) atlas->max_pages;
+    header.packer = atlas->packer;
+    header.used = (uint32_t) atlas->used;
+    header.glyph_count = (uint32_t) count;
+    header.kerning_count = (uint32_t) pair_count;
+    header.node_count = (uint32_t) vector_size( atlas->nodes );
+    header.node_size = (uint32_t) (atlas->nodes->item_size / sizeof(int));
+    header.freed_count = (uint32_t) vector_size( atlas->freed );
+    header.filename_length = font->filename ?
+                             (uint32_t) strlen( font->filename ) : 0;
+
+    end = font_cache_align( sizeof(font_cache_header_t) );
+    header.data_offset = (uint32_t) end;
+    end = font_cache_align( end + data_size );
+    header.glyph_offset = (uint32_t) end;
+    end = font_cache_align( end + count*sizeof(font_cache_glyph_t) );
+    header.kerning_offset = (uint32_t) end;
+    end = font_cache_align( end + pair_count*sizeof(font_cache_pair_t) );
+    header.node_offset = (uint32_t) end;
+    end = font_cache_align( end + vector_size( atlas->nodes )
+                                * atlas->nodes->item_size );
+    header.freed_offset = (uint32_t) end;
+    end = font_cache_align( end + vector_size( atlas->freed )*sizeof(ivec4) );
+    header.filename_offset = (uint32_t) end;
+    end += header.filename_length;
+    header.file_size = (uint32_t) end;
+
+    ok = 0;
+    file = (end <= UINT32_MAX) ? fopen( filename, "wb" ) : NULL;
+    if( file )
+    {
+        ok = font_cache_write( file, &header, sizeof(header), 0 ) &&
+             font_cache_write( file, atlas->data, data_size,
+                               header.data_offset ) &&
+             font_cache_write( file, glyphs,
+                               count*sizeof(font_cache_glyph_t),
+                               header.glyph_offset ) &&
+             font_cache_write( file, pairs,
+                               pair_count*sizeof(font_cache_pair_t),
+                               header.kerning_offset ) &&
+             font_cache_write( file, atlas->nodes->items,
+                               vector_size( atlas->nodes )
+                               * atlas->nodes->item_size,
+                               header.node_offset ) &&
+             font_cache_write( file, atlas->freed->items,
+                               vector_size( atlas->freed )*sizeof(ivec4),
+                               header.freed_offset ) &&
+             font_cache_write( file, font->filename, header.filename_length,
+                               header.filename_offset );
+        ok = (fclose( file ) == 0) && ok;
+    }
+    if( !ok )
+    {
+        fprintf( stderr, "Unable to write font cache \"%s\".\n", filename );
+    }
+    free( pairs );
+    free( glyphs );
+    return ok;
+}
+
+
+// ----------------------------------------------------- font_cache_section ---
+// Whether a section of count items lies within the file
+int
+font_cache_section( const uint32_t offset,
+                    const uint64_t count,
+                    const uint64_t item_size,
+                    const size_t size )
+{
+    return ((offset % FONT_CACHE_ALIGNMENT) == 0) &&
+           (offset + count*item_size <= size);
+}
+
+
+// -------------------------------------------------- font_cache_coordinate ---
+// Whether a texture coordinate lies within [0,1] (NaN does not)
+int
+font_cache_coordinate( const float value )
+{
+    return (value >= 0.0f) && (value <= 1.0f);
+}
+
+
+// ------------------------------------------------------- font_cache_check ---
+int
+font_cache_check( const font_cache_header_t * header,
+                  const size_t size )
+{
+    const font_cache_glyph_t *records;
+    uint64_t data_size;
+    uint32_t node_size;
+    size_t i;
+
+    if( (size < sizeof(font_cache_header_t)) ||
+        memcmp( header->magic, FONT_CACHE_MAGIC, sizeof(header->magic) ) ||
+        (header->version != FONT_CACHE_VERSION) ||
+        (header->byte_order != FONT_CACHE_BYTE_ORDER) ||
+        (header->header_size != sizeof(font_cache_header_t)) ||
+        (header->file_size != size) )
+    {
+        return 0;
+    }
+
+    node_size = ((header->packer == TEXTURE_ATLAS_MAXRECTS) ||
+                 (header->packer == TEXTURE_ATLAS_GUILLOTINE)) ? 4 : 3;
+    data_size = (uint64_t) header->page_count * header->width
+              * header->atlas_height * header->depth;
+    if( !((header->width > 2) && (header->atlas_height > 2) &&
+           ((header->depth == 1) || (header->depth == 3) ||
+            (header->depth == 4)) &&
+           (header->page_count >= 1) &&
+           (header->page_count <= header->max_pages) &&
+           (header->node_size == node_size) &&
+           font_cache_section( header->data_offset, data_size, 1, size ) &&
+           font_cache_section( header->glyph_offset, header->glyph_count,
+                               sizeof(font_cache_glyph_t), size ) &&
+           font_cache_section( header->kerning_offset,
+                               header->kerning_count,
+                               sizeof(font_cache_pair_t), size ) &&
+           font_cache_section( header->node_offset, header->node_count,
+                               node_size*sizeof(int32_t), size ) &&
+           font_cache_section( header->freed_offset, header->freed_count,
+                               4*sizeof(int32_t), size ) &&
+           (header->filename_offset + (uint64_t) header->filename_length
+            <= size)) )
+    {
+        return 0;
+    }
+
+    // Glyph records must point within the atlas
+    records = (const font_cache_glyph_t *)
+        ((const unsigned char *) header + header->glyph_offset);
+    for( i=0; i<header->glyph_count; ++i )
+    {
+        if( (records[i].page >= header->page_count) ||
+            !font_cache_coordinate( records[i].s0 ) ||
+            !font_cache_coordinate( records[i].t0 ) ||
+            !font_cache_coordinate( records[i].s1 ) ||
+            !font_cache_coordinate( records[i].t1 ) )
+        {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+// -------------------------------------------------------- font_cache_load ---
+texture_font_t *
+font_cache_load( const char * filename )
+{
+    const font_cache_header_t *header;
+    const font_cache_glyph_t *records;
+    const font_cache_pair_t *pairs;
+    const int32_t *nodes;
+    texture_atlas_t *atlas;
+    texture_font_t *font;
+    texture_glyph_t *glyph;
+    kerning_table_t *table;
+    unsigned char *base;
+    char *name;
+    size_t i, size = 0;
+
+    assert( filename );
+
+    base = (unsigned char *) platform_map_file( filename, &size );
+    if( !base )
+    {
+        fprintf( stderr, "Unable to open font cache \"%s\".\n", filename );
+        return NULL;
+    }
+    header = (const font_cache_header_t *) base;
+    if( !font_cache_check( header, size ) )
+    {
+        fprintf( stderr, "Invalid font cache \"%s\".\n", filename );
+        platform_unmap_file( base, size );
+        return NULL;
+    }
+
+    // Atlas pixels are used in place, the atlas owns the mapping
+    atlas = texture_atlas_new_with_packer( header->width, header->atlas_height,
+                                           header->depth, header->packer );
+    free( atlas->data );
+    atlas->data = base + header->data_offset;
+    atlas->mapping = base;
+    atlas->mapping_size = size;
+    atlas->page_count = header->page_count;
+    atlas->max_pages = header->max_pages;
+    atlas->used = header->used;
+    vector_clear( atlas->nodes );
+    nodes = (const int32_t *)( base + header->node_offset );
+    for( i=0; i<header->node_count; ++i )
+    {
+        ivec4 node;
+        memcpy( &node, nodes + i*header->node_size,
+                header->node_size*sizeof(int32_t) );
+        vector_push_back( atlas->nodes, &node );
+    }
+    nodes = (const int32_t *)( base + header->freed_offset );
+    for( i=0; i<header->freed_count; ++i )
+    {
+        ivec4 region;
+        memcpy( &region, nodes + 4*i, sizeof(ivec4) );
+        vector_push_back( atlas->freed, &region );
+    }
+
+    name = (char *) malloc( header->filename_length + 1 );
+    if( name == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    memcpy( name, base + header->filename_offset, header->filename_length );
+    name[header->filename_length] = 0;
+    font = texture_font_alloc( atlas, name, header->size );
+    free( name );
+    font->height = header->height;
+    font->linegap = header->linegap;
+    font->ascender = header->ascender;
+    font->descender = header->descender;
+    font->underline_position = header->underline_position;
+    font->underline_thickness = header->underline_thickness;
+    font->hinting = header->hinting;
+    font->kerning = header->kerning;
+    font->outline_type = header->outline_type;
+    font->outline_thickness = header->outline_thickness;
+    font->render_mode = header->render_mode;
+    font->padding = header->padding;
+    font->subpixel_phases = header->subpixel_phases;
+    font->phase = header->phase;
+
+    table = font->kerning_table;
+    pairs = (const font_cache_pair_t *)( base + header->kerning_offset );
+    for( i=0; i<header->kerning_count; ++i )
+    {
+        if( pairs[i].kerning )
+        {
+            kerning_table_set( table, (wchar_t) pairs[i].left,
+                               (wchar_t) pairs[i].right, pairs[i].kerning );
+        }
+    }
+
+    records = (const font_cache_glyph_t *)( base + header->glyph_offset );
+    for( i=0; i<header->glyph_count; ++i )
+    {
+        glyph = texture_glyph_new( );
+        glyph->charcode = (wchar_t) records[i].charcode;
+        glyph->glyph_index = records[i].glyph_index;
+        glyph->width = records[i].width;
+        glyph->height = records[i].height;
+        glyph->offset_x = records[i].offset_x;
+        glyph->offset_y = records[i].offset_y;
+        glyph->advance_x = records[i].advance_x;
+        glyph->advance_y = records[i].advance_y;
+        glyph->s0 = records[i].s0;
+        glyph->t0 = records[i].t0;
+        glyph->s1 = records[i].s1;
+        glyph->t1 = records[i].t1;
+        glyph->page = records[i].page;
+        glyph->outline_type = records[i].outline_type;
+        glyph->outline_thickness = records[i].outline_thickness;
+        glyph->phase = records[i].phase;
+        glyph->kerning_table = table;
+        vector_push_back( font->glyphs, &glyph );
+    }
+    // Kerning of every glyph is already known
+    font->kerning_count = header->glyph_count;
+
+    return font;
+}
@@ -0,0 +1,436 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#ifndef __FONT_CACHE_H__
+#define __FONT_CACHE_H__
+
+#include <stdint.h>
+#include "texture-atlas.h"
+#include "texture-font.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @file   font-cache.h
+ *
+ * @defgroup font-cache Font cache
+ *
+ * Binary files holding a texture font ready for use: atlas pixels, glyph
+ * records, kerning table and font metrics (see makefont). Loading a font
+ * cache does not involve freetype: the file is mapped in memory and the
+ * atlas pixels are used in place (they are only copied if the atlas is
+ * modified afterwards). Glyphs that are not in the cache cannot be loaded
+ * since the font has no face.
+ *
+ * Fields are stored in the byte order of the machine that wrote the file
+ * and files using another byte order or version are rejected.
+ *
+ * <b>Example Usage</b>:
+ * @code
+ * #include "font-cache.h"
+ *
+ * int main( int arrgc, char *argv[] )
+ * {
+ *     texture_font_t * font = font_cache_load( "arial-16.ftgl" );
+ *     texture_atlas_t * atlas = font->atlas;
+ *     texture_atlas_upload( atlas );
+ *     ...
+ *     texture_font_delete( font );
+ *     texture_atlas_delete( atlas );
+ *
+ *     return 0;
+ * }
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * File signature
+ */
+#define FONT_CACHE_MAGIC "FTGLFONT"
+
+/**
+ * Version of the file layout, increased whenever it changes
+ */
+#define FONT_CACHE_VERSION 2
+
+/**
+ * Byte order mark
+ */
+#define FONT_CACHE_BYTE_ORDER 0x01020304
+
+/**
+ * Alignment (in bytes) of the sections of a file
+ */
+#define FONT_CACHE_ALIGNMENT 16
+
+
+/**
+ * Font cache file header. Section offsets are relative to the start of the
+ * file.
+ */
+typedef struct
+{
+    /**
+     * FONT_CACHE_MAGIC (not null terminated)
+     */
+    char magic[8];
+
+    /**
+     * FONT_CACHE_VERSION
+     */
+    uint32_t version;
+
+    /**
+     * FONT_CACHE_BYTE_ORDER as written
+     */
+    uint32_t byte_order;
+
+    /**
+     * Size of this header
+     */
+    uint32_t header_size;
+
+    /**
+     * Size of the whole file
+     */
+    uint32_t file_size;
+
+    /**
+     * Font size
+     */
+    float size;
+
+    /**
+     * Default line spacing
+     */
+    float height;
+
+    /**
+     * Distance between two lines of text
+     */
+    float linegap;
+
+    /**
+     * Distance from the baseline to the highest coordinate
+     */
+    float ascender;
+
+    /**
+     * Distance from the baseline to the lowest coordinate
+     */
+    float descender;
+
+    /**
+     * Position of the underline relative to the baseline
+     */
+    float underline_position;
+
+    /**
+     * Thickness of the underline
+     */
+    float underline_thickness;
+
+    /**
+     * Whether glyphs were hinted
+     */
+    int32_t hinting;
+
+    /**
+     * Whether kerning is used
+     */
+    int32_t kerning;
+
+    /**
+     * Outline type of the font
+     */
+    int32_t outline_type;
+
+    /**
+     * Outline thickness of the font
+     */
+    float outline_thickness;
+
+    /**
+     * Glyph rendering mode
+     */
+    int32_t render_mode;
+
+    /**
+     * Padding around distance field glyphs
+     */
+    uint32_t padding;
+
+    /**
+     * Number of subpixel phases
+     */
+    uint32_t subpixel_phases;
+
+    /**
+     * Current subpixel phase
+     */
+    int32_t phase;
+
+    /**
+     * Atlas width
+     */
+    uint32_t width;
+
+    /**
+     * Atlas height (of a page)
+     */
+    uint32_t atlas_height;
+
+    /**
+     * Atlas depth
+     */
+    uint32_t depth;
+
+    /**
+     * Number of atlas pages
+     */
+    uint32_t page_count;
+
+    /**
+     * Maximum number of atlas pages
+     */
+    uint32_t max_pages;
+
+    /**
+     * Atlas packing strategy
+     */
+    int32_t packer;
+
+    /**
+     * Allocated atlas surface
+     */
+    uint32_t used;
+
+    /**
+     * Offset of the atlas pixels (page_count*width*atlas_height*depth)
+     */
+    uint32_t data_offset;
+
+    /**
+     * Offset of the glyph records (font_cache_glyph_t)
+     */
+    uint32_t glyph_offset;
+
+    /**
+     * Number of glyph records
+     */
+    uint32_t glyph_count;
+
+    /**
+     * Offset of the kerning pairs (font_cache_pair_t)
+     */
+    uint32_t kerning_offset;
+
+    /**
+     * Number of kerning pairs
+     */
+    uint32_t kerning_count;
+
+    /**
+     * Offset of the atlas packing nodes (int32_t)
+     */
+    uint32_t node_offset;
+
+    /**
+     * Number of atlas packing nodes
+     */
+    uint32_t node_count;
+
+    /**
+     * Number of integers per node (3 or 4, see texture_atlas_t.nodes)
+     */
+    uint32_t node_size;
+
+    /**
+     * Offset of the freed atlas regions (4 int32_t each)
+     */
+    uint32_t freed_offset;
+
+    /**
+     * Number of freed atlas regions
+     */
+    uint32_t freed_count;
+
+    /**
+     * Offset of the filename of the font the glyphs come from
+     */
+    uint32_t filename_offset;
+
+    /**
+     * Length of the filename (not null terminated)
+     */
+    uint32_t filename_length;
+
+} font_cache_header_t;
+
+
+/**
+ * Glyph record of a font cache (see texture_glyph_t)
+ */
+typedef struct
+{
+    /**
+     * Character code ((uint32_t)(-1) for the special background glyph)
+     */
+    uint32_t charcode;
+
+    /**
+     * Glyph index in the font
+     */
+    uint32_t glyph_index;
+
+    /**
+     * Glyph width in pixels
+     */
+    uint32_t width;
+
+    /**
+     * Glyph height in pixels
+     */
+    uint32_t height;
+
+    /**
+     * Glyph left bearing
+     */
+    int32_t offset_x;
+
+    /**
+     * Glyph top bearing
+     */
+    int32_t offset_y;
+
+    /**
+     * Horizontal advance
+     */
+    float advance_x;
+
+    /**
+     * Vertical advance
+     */
+    float advance_y;
+
+    /**
+     * Texture coordinates
+     */
+    float s0, t0, s1, t1;
+
+    /**
+     * Atlas page
+     */
+    uint32_t page;
+
+    /**
+     * Outline type of the glyph
+     */
+    int32_t outline_type;
+
+    /**
+     * Outline thickness of the glyph
+     */
+    float outline_thickness;
+
+    /**
+     * Subpixel phase of the glyph
+     */
+    int32_t phase;
+
+} font_cache_glyph_t;
+
+
+/**
+ * Kerning pair of a font cache (see kerning_table_t)
+ */
+typedef struct
+{
+    /**
+     * Left character code
+     */
+    uint32_t left;
+
+    /**
+     * Right character code
+     */
+    uint32_t right;
+
+    /**
+     * Kerning value (in fractional pixels)
+     */
+    float kerning;
+
+} font_cache_pair_t;
+
+
+/**
+ * Write the glyphs loaded by a texture font, its atlas and its metrics to a
+ * font cache file. Glyphs still being rasterized in background are not
+ * saved.
+ *
+ * @param font     a valid texture font
+ * @param filename font cache filename
+ *
+ * @return 1 on success, 0 if the file cannot be written
+ */
+  int
+  font_cache_save( texture_font_t * font,
+                   const char * filename );
+
+
+/**
+ * Load a texture font and its atlas from a font cache file. The atlas
+ * (font->atlas) belongs to the caller and must be deleted after the font.
+ *
+ * @param filename font cache filename
+ *
+ * @return a new texture font or NULL if the file cannot be read or is not a
+ *         valid font cache (including glyphs outside of the atlas pages)
+ */
+  texture_font_t *
+  font_cache_load( const char * filename );
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FONT_CACHE_H__ */
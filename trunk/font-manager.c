@@ -85,6 +85,14 @@ font_manager_new( size_t width, size_t height, size_t depth )
     self->atlas = atlas;
     self->fonts = vector_new( sizeof(texture_font_t *) );
     self->cache = wcsdup( L" " );
+    self->budget = 0;
+    self->subpixel_phases = 0;
+    if( FT_Init_FreeType( &self->library ) )
+    {
+        fprintf( stderr,
+                 "line %d: Unable to initialize freetype library\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
     return self;
 }
 
@@ -103,6 +111,7 @@ font_manager_delete( font_manager_t * self )
         texture_font_delete( font );
     }
     vector_delete( self->fonts );
+    FT_Done_FreeType( self->library );
     texture_atlas_delete( self->atlas );
     if( self->cache )
     {
@@ -139,6 +148,143 @@ font_manager_delete_font( font_manager_t * self,
 
 
 
+// ------------------------------------------------ font_manager_lru_compare ---
+int
+font_manager_lru_compare( const void * a,
+                          const void * b )
+{
+    size_t t1 = (*(const texture_glyph_t **) a)->last_used;
+    size_t t2 = (*(const texture_glyph_t **) b)->last_used;
+
+    return (t1 > t2) - (t1 < t2);
+}
+
+
+// ------------------------------------------------------ font_manager_evict ---
+size_t
+font_manager_evict( font_manager_t * self )
+{
+    size_t i, j, used, target, before, area, count = 0;
+    texture_font_t *font;
+    texture_glyph_t *glyph;
+    vector_t *glyphs;
+
+    assert( self );
+
+    used = self->atlas->used * self->atlas->depth;
+    if( !self->budget || (used <= self->budget) )
+    {
+        return 0;
+    }
+    target = self->budget - self->budget/4;
+
+    glyphs = vector_new( sizeof(texture_glyph_t *) );
+    for( i=0; i<vector_size( self->fonts ); ++i )
+    {
+        font = *(texture_font_t **) vector_get( self->fonts, i );
+        for( j=0; j<vector_size( font->glyphs ); ++j )
+        {
+            glyph = *(texture_glyph_t **) vector_get( font->glyphs, j );
+            // Pending glyphs are not placed yet and are never removed
+            if( (glyph->charcode != (wchar_t)(-1)) && !glyph->pending )
+            {
+                vector_push_back( glyphs, &glyph );
+            }
+        }
+    }
+    qsort( glyphs->items, vector_size( glyphs ), sizeof(texture_glyph_t *),
+           font_manager_lru_compare );
+
+    // Find the clock value such that removing older glyphs meets the target
+    before = 0;
+    for( i=0; (i<vector_size( glyphs )) && (used > target); ++i )
+    {
+        glyph = *(texture_glyph_t **) vector_get( glyphs, i );
+        area = (glyph->width+1)*(glyph->height+1)*self->atlas->depth;
+        used = (area < used) ? used - area : 0;
+        before = glyph->last_used + 1;
+    }
+    vector_delete( glyphs );
+
+    for( i=0; i<vector_size( self->fonts ); ++i )
+    {
+        font = *(texture_font_t **) vector_get( self->fonts, i );
+        count += texture_font_remove_glyphs( font, before );
+    }
+    return count;
+}
+
+
+// ---------------------------------------------------- font_manager_compact ---
+size_t
+font_manager_compact( font_manager_t * self,
+                      vector_t * moved )
+{
+    size_t i, j, k, count = 0;
+    texture_font_t *font;
+    texture_glyph_t *glyph;
+    vector_t *regions;
+    ivec4 *result, region;
+
+    assert( self );
+
+    regions = vector_new( sizeof(ivec4) );
+    for( i=0; i<vector_size( self->fonts ); ++i )
+    {
+        font = *(texture_font_t **) vector_get( self->fonts, i );
+        for( j=0; j<vector_size( font->glyphs ); ++j )
+        {
+            glyph = *(texture_glyph_t **) vector_get( font->glyphs, j );
+            // Pending glyphs have no region yet
+            if( glyph->pending )
+            {
+                continue;
+            }
+            region = texture_font_get_glyph_region( font, glyph );
+            vector_push_back( regions, &region );
+        }
+    }
+
+    result = (ivec4 *) malloc( (vector_size( regions )+1) * sizeof(ivec4) );
+    if( !result )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    if( texture_atlas_repack( self->atlas, (ivec4 *) regions->items, result,
+                              vector_size( regions ) ) )
+    {
+        for( i=0, k=0; i<vector_size( self->fonts ); ++i )
+        {
+            font = *(texture_font_t **) vector_get( self->fonts, i );
+            for( j=0; j<vector_size( font->glyphs ); ++j )
+            {
+                glyph = *(texture_glyph_t **) vector_get( font->glyphs, j );
+                if( glyph->pending )
+                {
+                    continue;
+                }
+                region = *(ivec4 *) vector_get( regions, k++ );
+                if( (region.x == result[k-1].x) && (region.y == result[k-1].y) )
+                {
+                    continue;
+                }
+                texture_font_set_glyph_region( font, glyph, result[k-1] );
+                if( moved )
+                {
+                    vector_push_back( moved, &glyph );
+                }
+                ++count;
+            }
+        }
+    }
+    free( result );
+    vector_delete( regions );
+    return count;
+}
+
+
 // ----------------------------------------- font_manager_get_from_filename ---
 texture_font_t *
 font_manager_get_from_filename( font_manager_t *self,
@@ -157,11 +303,13 @@ font_manager_get_from_filename( font_manager_t *self,
             return font;
         }
     }
-    font = texture_font_new( self->atlas, filename, size );
+    font = texture_font_new_with_library( self->atlas, self->library,
+                                          filename, size );
     if( font )
     {
+        font->subpixel_phases = self->subpixel_phases;
         vector_push_back( self->fonts, &font );
-        texture_font_load_glyphs( font, self->cache );
+        texture_font_load_charset( font, self->cache );
         return font;
     }
     fprintf( stderr, "Unable to load \"%s\" (size=%.1f)\n", filename, size );
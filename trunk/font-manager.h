@@ -87,6 +87,25 @@ typedef struct {
      */
     wchar_t * cache;
 
+    /**
+     * Freetype library handle shared by all the fonts of the manager.
+     */
+    FT_Library library;
+
+    /**
+     * Maximum number of bytes used by glyphs in the atlas (0 means no
+     * limit). Enforced by font_manager_evict, atlas max_width and
+     * max_height should be set as well for the atlas not to grow because of
+     * fragmentation.
+     */
+    size_t budget;
+
+    /**
+     * Horizontal subpixel phases of the fonts created by the manager (see
+     * texture_font_t.subpixel_phases, 0 by default)
+     */
+    size_t subpixel_phases;
+
 } font_manager_t;
 
 
@@ -94,8 +113,8 @@ typedef struct {
 /**
  * Creates a new empty font manager.
  *
- * @param   width   width of the underlying atlas
- * @param   height  height of the underlying atlas
+ * @param   width   initial width of the underlying atlas (it grows as needed)
+ * @param   height  initial height of the underlying atlas (it grows as needed)
  * @param   depth   bit depth of the underlying atlas
  *
  * @return          a new font manager.
@@ -177,6 +196,36 @@ typedef struct {
                                 const markup_t *markup );
 
 
+/**
+ *  Remove least recently used glyphs (of all fonts) when the atlas uses more
+ *  than the budget, until it uses less than 3/4 of it.
+ *
+ *  Texture coordinates of removed glyphs may be given to new glyphs, text
+ *  that used them must be laid out again.
+ *
+ *  @param self    a font manager
+ *
+ *  @return Number of removed glyphs
+ */
+  size_t
+  font_manager_evict( font_manager_t * self );
+
+
+/**
+ *  Pack glyphs of all fonts again from scratch to get rid of fragmentation
+ *  left by removed glyphs.
+ *
+ *  @param self    a font manager
+ *  @param moved   if not NULL, glyphs (texture_glyph_t *) whose texture
+ *                 coordinates changed are appended to this vector
+ *
+ *  @return Number of moved glyphs
+ */
+  size_t
+  font_manager_compact( font_manager_t * self,
+                        vector_t * moved );
+
+
 /**
  *  Search for a font filename that match description.
  *
@@ -0,0 +1,539 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_SIZES_H
+#include FT_OUTLINE_H
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+#include <wchar.h>
+#include "font-registry.h"
+#include "font-metrics.h"
+
+
+// ------------------------------------------------------ font_metrics_hash ---
+uint32_t
+font_metrics_hash( const wchar_t left,
+                   const wchar_t right )
+{
+    uint32_t h = (uint32_t) left * 31 + (uint32_t) right;
+
+    // Murmur3 finalizer, charcodes are mostly contiguous
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+
+// -------------------------------------------------- font_metrics_set_size ---
+// Same scaling as texture_font_set_size (horizontal resolution 64 times
+// higher, scaled back by the transform) such that hinting and metrics are
+// the ones of texture fonts.
+FT_Error
+font_metrics_set_size( FT_Face face,
+                       const float size )
+{
+    size_t hres = 64;
+    FT_Error error;
+    FT_Matrix matrix = { (int)((1.0/hres) * 0x10000L),
+                         (int)((0.0)      * 0x10000L),
+                         (int)((0.0)      * 0x10000L),
+                         (int)((1.0)      * 0x10000L) };
+
+    error = FT_Set_Char_Size( face, (int)(size*64), 0, 72*hres, 72 );
+    if( error )
+    {
+        return error;
+    }
+    FT_Set_Transform( face, &matrix, NULL );
+    return 0;
+}
+
+
+// -------------------------------------------------- font_metrics_activate ---
+// The face is shared with other fonts that may have changed its size
+void
+font_metrics_activate( font_metrics_t * self )
+{
+    if( self->face->size != self->size_object )
+    {
+        FT_Activate_Size( self->size_object );
+    }
+}
+
+
+// ------------------------------------------------------- font_metrics_new ---
+font_metrics_t *
+font_metrics_new( const char * filename,
+                  const float size )
+{
+    font_metrics_t *self;
+    FT_Library library;
+    FT_Size_Metrics metrics;
+    FT_Face face;
+    size_t i;
+    int hires;
+
+    assert( filename );
+    assert( size );
+
+    library = font_registry_get_library( );
+    if( !library )
+    {
+        return NULL;
+    }
+    self = (font_metrics_t *) calloc( 1, sizeof(font_metrics_t) );
+    if( self == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->filename = strdup( filename );
+    self->size = size;
+    self->hinting = 1;
+    self->kerning = 1;
+    self->glyph_capacity = 128;
+    self->glyphs = (glyph_metrics_t *)
+        malloc( self->glyph_capacity * sizeof(glyph_metrics_t) );
+    self->pair_capacity = 64;
+    self->pairs = (metrics_pair_t *)
+        malloc( self->pair_capacity * sizeof(metrics_pair_t) );
+    if( !self->filename || !self->glyphs || !self->pairs )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    for( i=0; i<self->glyph_capacity; ++i )
+    {
+        self->glyphs[i].charcode = (wchar_t)(-1);
+    }
+    for( i=0; i<self->pair_capacity; ++i )
+    {
+        self->pairs[i].left = (wchar_t)(-1);
+    }
+
+    self->file = font_registry_open( filename );
+    if( self->file )
+    {
+        self->shared = font_registry_open_face( self->file, library );
+    }
+    if( !self->shared ||
+        FT_New_Size( self->shared->face, &self->size_object ) )
+    {
+        font_metrics_delete( self );
+        return NULL;
+    }
+    face = self->shared->face;
+    if( FT_Activate_Size( self->size_object ) ||
+        font_metrics_set_size( face, size ) )
+    {
+        fprintf( stderr, "FT_Error (line %d) : cannot set size %.1f\n",
+                 __LINE__, size );
+        font_metrics_delete( self );
+        return NULL;
+    }
+    self->face = face;
+
+    /* Font metrics at high resolution, as texture_font_new does */
+    hires = 100;
+    if( font_metrics_set_size( face, size*hires ) )
+    {
+        hires = 1;
+        font_metrics_set_size( face, size );
+    }
+    metrics = face->size->metrics;
+    self->ascender = (metrics.ascender >> 6) / (float) hires;
+    self->descender = (metrics.descender >> 6) / (float) hires;
+    self->height = (metrics.height >> 6) / (float) hires;
+    self->linegap = self->height - self->ascender + self->descender;
+    if( hires != 1 )
+    {
+        font_metrics_set_size( face, size );
+    }
+
+    return self;
+}
+
+
+// ---------------------------------------------------- font_metrics_delete ---
+void
+font_metrics_delete( font_metrics_t * self )
+{
+    assert( self );
+
+    if( self->shared )
+    {
+        if( self->size_object )
+        {
+            FT_Done_Size( self->size_object );
+        }
+        font_registry_close_face( self->file, self->shared );
+    }
+    // After faces, which use its content
+    if( self->file )
+    {
+        font_registry_close( self->file );
+    }
+    font_registry_release_library( );
+    free( self->pairs );
+    free( self->glyphs );
+    free( self->filename );
+    free( self );
+}
+
+
+// ------------------------------------------------------ font_metrics_grow ---
+void
+font_metrics_grow( font_metrics_t * self )
+{
+    glyph_metrics_t *old = self->glyphs;
+    size_t capacity = self->glyph_capacity;
+    size_t mask, i, j;
+
+    self->glyph_capacity = capacity * 2;
+    self->glyphs = (glyph_metrics_t *)
+        malloc( self->glyph_capacity * sizeof(glyph_metrics_t) );
+    if( self->glyphs == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    for( i=0; i<self->glyph_capacity; ++i )
+    {
+        self->glyphs[i].charcode = (wchar_t)(-1);
+    }
+    mask = self->glyph_capacity - 1;
+    for( i=0; i<capacity; ++i )
+    {
+        if( old[i].charcode == (wchar_t)(-1) )
+        {
+            continue;
+        }
+        j = font_metrics_hash( old[i].charcode, 0 ) & mask;
+        while( self->glyphs[j].charcode != (wchar_t)(-1) )
+        {
+            j = (j+1) & mask;
+        }
+        self->glyphs[j] = old[i];
+    }
+    free( old );
+}
+
+
+// ------------------------------------------------ font_metrics_load_glyph ---
+int
+font_metrics_load_glyph( font_metrics_t * self,
+                         glyph_metrics_t * glyph )
+{
+    FT_Int32 flags = FT_LOAD_NO_BITMAP;
+    FT_GlyphSlot slot;
+    FT_BBox bbox;
+    FT_Error error;
+
+    glyph->glyph_index = font_registry_glyph_index( self->shared,
+                                                    glyph->charcode );
+    if( !self->hinting )
+    {
+        flags |= FT_LOAD_NO_HINTING | FT_LOAD_NO_AUTOHINT;
+    }
+    else
+    {
+        flags |= FT_LOAD_FORCE_AUTOHINT;
+    }
+    font_metrics_activate( self );
+    error = FT_Load_Glyph( self->face, glyph->glyph_index, flags );
+    if( error )
+    {
+        fprintf( stderr, "FT_Error (line %d, code 0x%02x)\n", __LINE__, error );
+        return 0;
+    }
+    slot = self->face->glyph;
+
+    // Unhinted advance (16.16) at the horizontal resolution used in
+    // font_metrics_set_size (hres = 64)
+    glyph->advance_x = slot->linearHoriAdvance / (float)(65536.0f*64.0f);
+    glyph->advance_y = slot->advance.y/64.0;
+
+    // The bitmap of the glyph covers the pixels its outline control box
+    // touches (26.6)
+    glyph->offset_x = glyph->offset_y = 0;
+    glyph->width = glyph->height = 0;
+    if( (slot->format == FT_GLYPH_FORMAT_OUTLINE) &&
+        (slot->outline.n_points > 0) )
+    {
+        FT_Outline_Get_CBox( &slot->outline, &bbox );
+        glyph->offset_x = (int) floor( bbox.xMin / 64.0 );
+        glyph->offset_y = (int) ceil( bbox.yMax / 64.0 );
+        glyph->width  = (unsigned short)
+            ( (int) ceil( bbox.xMax / 64.0 ) - glyph->offset_x );
+        glyph->height = (unsigned short)
+            ( glyph->offset_y - (int) floor( bbox.yMin / 64.0 ) );
+    }
+    return 1;
+}
+
+
+// ------------------------------------------------- font_metrics_get_glyph ---
+const glyph_metrics_t *
+font_metrics_get_glyph( font_metrics_t * self,
+                        wchar_t charcode )
+{
+    glyph_metrics_t *glyph;
+    size_t mask, i;
+
+    assert( self );
+
+    if( !self->face || (charcode == (wchar_t)(-1)) )
+    {
+        return NULL;
+    }
+
+    mask = self->glyph_capacity - 1;
+    i = font_metrics_hash( charcode, 0 ) & mask;
+    while( self->glyphs[i].charcode != (wchar_t)(-1) )
+    {
+        if( self->glyphs[i].charcode == charcode )
+        {
+            return &self->glyphs[i];
+        }
+        i = (i+1) & mask;
+    }
+
+    /* Keep the load factor under one half */
+    if( 2*(self->glyph_count+1) > self->glyph_capacity )
+    {
+        font_metrics_grow( self );
+        mask = self->glyph_capacity - 1;
+        i = font_metrics_hash( charcode, 0 ) & mask;
+        while( self->glyphs[i].charcode != (wchar_t)(-1) )
+        {
+            i = (i+1) & mask;
+        }
+    }
+    glyph = &self->glyphs[i];
+    glyph->charcode = charcode;
+    if( !font_metrics_load_glyph( self, glyph ) )
+    {
+        glyph->charcode = (wchar_t)(-1);
+        return NULL;
+    }
+    self->glyph_count++;
+    return glyph;
+}
+
+
+// ------------------------------------------------ font_metrics_grow_pairs ---
+void
+font_metrics_grow_pairs( font_metrics_t * self )
+{
+    metrics_pair_t *old = self->pairs;
+    size_t capacity = self->pair_capacity;
+    size_t mask, i, j;
+
+    self->pair_capacity = capacity * 2;
+    self->pairs = (metrics_pair_t *)
+        malloc( self->pair_capacity * sizeof(metrics_pair_t) );
+    if( self->pairs == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    for( i=0; i<self->pair_capacity; ++i )
+    {
+        self->pairs[i].left = (wchar_t)(-1);
+    }
+    mask = self->pair_capacity - 1;
+    for( i=0; i<capacity; ++i )
+    {
+        if( old[i].left == (wchar_t)(-1) )
+        {
+            continue;
+        }
+        j = font_metrics_hash( old[i].left, old[i].right ) & mask;
+        while( self->pairs[j].left != (wchar_t)(-1) )
+        {
+            j = (j+1) & mask;
+        }
+        self->pairs[j] = old[i];
+    }
+    free( old );
+}
+
+
+// ----------------------------------------------- font_metrics_get_kerning ---
+float
+font_metrics_get_kerning( font_metrics_t * self,
+                          const wchar_t left,
+                          const wchar_t right )
+{
+    const glyph_metrics_t *glyph;
+    metrics_pair_t *pair;
+    FT_UInt left_index;
+    FT_Vector kerning;
+    size_t mask, i;
+
+    assert( self );
+
+    if( !self->face || !FT_HAS_KERNING( self->face ) ||
+        (left == (wchar_t)(-1)) )
+    {
+        return 0;
+    }
+
+    mask = self->pair_capacity - 1;
+    i = font_metrics_hash( left, right ) & mask;
+    while( self->pairs[i].left != (wchar_t)(-1) )
+    {
+        if( (self->pairs[i].left == left) && (self->pairs[i].right == right) )
+        {
+            return self->pairs[i].kerning;
+        }
+        i = (i+1) & mask;
+    }
+
+    /* Glyph indices come with the glyph metrics */
+    glyph = font_metrics_get_glyph( self, left );
+    if( !glyph )
+    {
+        return 0;
+    }
+    left_index = glyph->glyph_index;
+    glyph = font_metrics_get_glyph( self, right );
+    if( !glyph )
+    {
+        return 0;
+    }
+
+    if( 2*(self->pair_count+1) > self->pair_capacity )
+    {
+        font_metrics_grow_pairs( self );
+    }
+    mask = self->pair_capacity - 1;
+    i = font_metrics_hash( left, right ) & mask;
+    while( self->pairs[i].left != (wchar_t)(-1) )
+    {
+        i = (i+1) & mask;
+    }
+    pair = &self->pairs[i];
+    pair->left = left;
+    pair->right = right;
+    pair->kerning = 0;
+
+    // 64 * 64 because of 26.6 encoding AND the transform matrix used
+    // in font_metrics_set_size (hres = 64)
+    font_metrics_activate( self );
+    if( !FT_Get_Kerning( self->face, left_index, glyph->glyph_index,
+                         FT_KERNING_UNFITTED, &kerning ) )
+    {
+        pair->kerning = kerning.x / (float)(64.0f*64.0f);
+    }
+    self->pair_count++;
+    return pair->kerning;
+}
+
+
+// --------------------------------------------------- font_metrics_measure ---
+vec4
+font_metrics_measure( font_metrics_t * self,
+                      const wchar_t * text,
+                      float * advance )
+{
+    const glyph_metrics_t *glyph;
+    vec4 bbox = {{0,0,0,0}};
+    float left = 0, right = 0, bottom = 0, top = 0;
+    float pen = 0, x0, y0;
+    int empty = 1;
+    size_t i;
+
+    assert( self );
+    assert( text );
+
+    for( i=0; text[i]; ++i )
+    {
+        if( (i > 0) && self->kerning )
+        {
+            pen += font_metrics_get_kerning( self, text[i-1], text[i] );
+        }
+        glyph = font_metrics_get_glyph( self, text[i] );
+        if( !glyph )
+        {
+            continue;
+        }
+        if( glyph->width && glyph->height )
+        {
+            x0 = pen + glyph->offset_x;
+            y0 = (float)( glyph->offset_y - glyph->height );
+            if( empty )
+            {
+                left = x0;
+                right = x0 + glyph->width;
+                bottom = y0;
+                top = (float) glyph->offset_y;
+                empty = 0;
+            }
+            else
+            {
+                if( x0 < left ) left = x0;
+                if( x0 + glyph->width > right ) right = x0 + glyph->width;
+                if( y0 < bottom ) bottom = y0;
+                if( glyph->offset_y > top ) top = (float) glyph->offset_y;
+            }
+        }
+        pen += glyph->advance_x;
+    }
+
+    if( advance )
+    {
+        *advance = pen;
+    }
+    if( !empty )
+    {
+        bbox.x = left;
+        bbox.y = bottom;
+        bbox.width = right - left;
+        bbox.height = top - bottom;
+    }
+    return bbox;
+}
@@ -0,0 +1,335 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#ifndef __FONT_METRICS_H__
+#define __FONT_METRICS_H__
+
+#include <stdlib.h>
+#include <wchar.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_SIZES_H
+#include "font-registry.h"
+#include "vec234.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @file   font-metrics.h
+ *
+ * @defgroup font-metrics Font metrics
+ *
+ * Glyph metrics of a font for text layout and measurement, without any
+ * rasterization: glyphs are loaded as outlines (FT_LOAD_NO_BITMAP) and
+ * only their advance, bearings and extent are kept, along with kerning
+ * values, in compact hash tables. No texture atlas nor OpenGL context is
+ * needed and values are the ones of the texture font of same file, size
+ * and hinting (glyph extents being the ones of the glyph bitmaps, without
+ * padding). Font files and faces are shared with texture fonts through the
+ * font registry.
+ *
+ * <b>Example Usage</b>:
+ * @code
+ * #include "font-metrics.h"
+ *
+ * int main( int arrgc, char *argv[] )
+ * {
+ *     font_metrics_t * font = font_metrics_new( "Vera.ttf", 16 );
+ *     float advance;
+ *     vec4 bbox = font_metrics_measure( font, L"Hello World", &advance );
+ *     font_metrics_delete( font );
+ *
+ *     return 0;
+ * }
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * Metrics of a glyph, in pixels (y axis upward).
+ */
+typedef struct
+{
+    /**
+     * Character code, (wchar_t)(-1) for an empty slot.
+     */
+    wchar_t charcode;
+
+    /**
+     * Glyph index in the face (0 if the face has no glyph for charcode).
+     */
+    FT_UInt glyph_index;
+
+    /**
+     * Horizontal advance (unhinted).
+     */
+    float advance_x;
+
+    /**
+     * Vertical advance.
+     */
+    float advance_y;
+
+    /**
+     * Distance from the pen position to the left of the glyph bitmap.
+     */
+    int offset_x;
+
+    /**
+     * Distance from the baseline to the top of the glyph bitmap.
+     */
+    int offset_y;
+
+    /**
+     * Width of the glyph bitmap.
+     */
+    unsigned short width;
+
+    /**
+     * Height of the glyph bitmap.
+     */
+    unsigned short height;
+
+} glyph_metrics_t;
+
+
+
+/**
+ * Kerning value of a charcode pair, null values included.
+ */
+typedef struct
+{
+    /**
+     * Left character code, (wchar_t)(-1) for an empty slot.
+     */
+    wchar_t left;
+
+    /**
+     * Right character code.
+     */
+    wchar_t right;
+
+    /**
+     * Kerning value (in fractional pixels).
+     */
+    float kerning;
+
+} metrics_pair_t;
+
+
+
+/**
+ * Layout metrics of a font at a given size.
+ */
+typedef struct
+{
+    /**
+     * Font filename
+     */
+    char * filename;
+
+    /**
+     * Font size
+     */
+    float size;
+
+    /**
+     * Whether to use autohint when loading glyphs (must be set before any
+     * glyph is loaded)
+     */
+    int hinting;
+
+    /**
+     * Whether to use kerning in font_metrics_measure
+     */
+    int kerning;
+
+    /**
+     * This field is simply used to compute a default line spacing (i.e., the
+     * baseline-to-baseline distance) when writing text with this font.
+     */
+    float height;
+
+    /**
+     * This field is the distance that must be placed between two lines of
+     * text.
+     */
+    float linegap;
+
+    /**
+     * The ascender is the vertical distance from the horizontal baseline to
+     * the highest 'character' coordinate in a font face.
+     */
+    float ascender;
+
+    /**
+     * The descender is the vertical distance from the horizontal baseline to
+     * the lowest 'character' coordinate in a font face.
+     */
+    float descender;
+
+    /**
+     * Glyph metrics, in an open addressing hash table (linear probing)
+     * keyed on the charcode.
+     */
+    glyph_metrics_t * glyphs;
+
+    /**
+     * Number of glyph slots (always a power of two).
+     */
+    size_t glyph_capacity;
+
+    /**
+     * Number of glyphs loaded so far.
+     */
+    size_t glyph_count;
+
+    /**
+     * Kerning values looked up so far, in an open addressing hash table
+     * keyed on the charcode pair.
+     */
+    metrics_pair_t * pairs;
+
+    /**
+     * Number of pair slots (always a power of two).
+     */
+    size_t pair_capacity;
+
+    /**
+     * Number of kerning values stored.
+     */
+    size_t pair_count;
+
+    /**
+     * Font file (shared through the font registry)
+     */
+    font_file_t * file;
+
+    /**
+     * Face shared with the other fonts of the same file
+     */
+    font_face_t * shared;
+
+    /**
+     * Freetype size of the font
+     */
+    FT_Size size_object;
+
+    /**
+     * Freetype face (NULL if the font cannot be loaded)
+     */
+    FT_Face face;
+
+} font_metrics_t;
+
+
+
+/**
+ * Create the metrics of a font.
+ *
+ * @param filename font filename
+ * @param size     font size
+ *
+ * @return a new font metrics or NULL if the font cannot be loaded
+ */
+  font_metrics_t *
+  font_metrics_new( const char * filename,
+                    const float size );
+
+
+/**
+ * Delete font metrics.
+ *
+ * @param self a valid font metrics
+ */
+  void
+  font_metrics_delete( font_metrics_t * self );
+
+
+/**
+ * Get the metrics of a glyph, loading them on first request.
+ *
+ * @param self     a valid font metrics
+ * @param charcode character codepoint
+ *
+ * @return the glyph metrics (valid until the next glyph is loaded) or NULL
+ *         if the glyph cannot be loaded
+ */
+  const glyph_metrics_t *
+  font_metrics_get_glyph( font_metrics_t * self,
+                          wchar_t charcode );
+
+
+/**
+ * Get the kerning between two characters.
+ *
+ * @param self  a valid font metrics
+ * @param left  left character code
+ * @param right right character code
+ *
+ * @return x kerning value
+ */
+  float
+  font_metrics_get_kerning( font_metrics_t * self,
+                            const wchar_t left,
+                            const wchar_t right );
+
+
+/**
+ * Measure a single line of text written from the origin.
+ *
+ * @param self    a valid font metrics
+ * @param text    text to measure
+ * @param advance where to store the pen position after the text (may be
+ *                NULL)
+ *
+ * @return bounding box of the glyph bitmaps (x, y of the bottom left
+ *         corner, width, height)
+ */
+  vec4
+  font_metrics_measure( font_metrics_t * self,
+                        const wchar_t * text,
+                        float * advance );
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FONT_METRICS_H__ */
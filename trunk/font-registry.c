@@ -0,0 +1,366 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#include "platform.h"
+#include "vector.h"
+#include "font-registry.h"
+
+
+// ------------------------------------------------------- global variables ---
+// Open font files (font_file_t *)
+vector_t * font_registry_files = NULL;
+
+// Library of the fonts created with texture_font_new and its users
+FT_Library font_registry_library = NULL;
+size_t font_registry_library_count = 0;
+
+
+// ----------------------------------------------------- font_registry_read ---
+// Fallback when a file cannot be mapped
+int
+font_registry_read( font_file_t * file )
+{
+    FILE *stream;
+    long size;
+
+    stream = fopen( file->filename, "rb" );
+    if( !stream )
+    {
+        return 0;
+    }
+    fseek( stream, 0, SEEK_END );
+    size = ftell( stream );
+    fseek( stream, 0, SEEK_SET );
+    if( size <= 0 )
+    {
+        fclose( stream );
+        return 0;
+    }
+    file->data = (unsigned char *) malloc( size );
+    if( file->data == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    file->size = fread( file->data, 1, size, stream );
+    fclose( stream );
+    if( file->size != (size_t) size )
+    {
+        free( file->data );
+        return 0;
+    }
+    return 1;
+}
+
+
+// ----------------------------------------------------- font_registry_open ---
+font_file_t *
+font_registry_open( const char * filename )
+{
+    font_file_t *file;
+    size_t i;
+
+    assert( filename );
+
+    if( !font_registry_files )
+    {
+        font_registry_files = vector_new( sizeof(font_file_t *) );
+    }
+    for( i=0; i<vector_size( font_registry_files ); ++i )
+    {
+        file = *(font_file_t **) vector_get( font_registry_files, i );
+        if( strcmp( file->filename, filename ) == 0 )
+        {
+            file->refcount++;
+            return file;
+        }
+    }
+
+    file = (font_file_t *) malloc( sizeof(font_file_t) );
+    if( file == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    file->filename = strdup( filename );
+    file->size = 0;
+    file->refcount = 1;
+    file->faces = vector_new( sizeof(font_face_t *) );
+    file->data = (unsigned char *) platform_map_file( filename, &file->size );
+    file->mapped = file->data != NULL;
+    if( !file->mapped && !font_registry_read( file ) )
+    {
+        fprintf( stderr, "Unable to open font file \"%s\".\n", filename );
+        vector_delete( file->faces );
+        free( file->filename );
+        free( file );
+        return NULL;
+    }
+    vector_push_back( font_registry_files, &file );
+    return file;
+}
+
+
+// ---------------------------------------------------- font_registry_close ---
+void
+font_registry_close( font_file_t * file )
+{
+    size_t i;
+
+    assert( file );
+
+    if( --file->refcount )
+    {
+        return;
+    }
+    for( i=0; i<vector_size( font_registry_files ); ++i )
+    {
+        if( *(font_file_t **) vector_get( font_registry_files, i ) == file )
+        {
+            vector_erase( font_registry_files, i );
+            break;
+        }
+    }
+    if( file->mapped )
+    {
+        platform_unmap_file( file->data, file->size );
+    }
+    else
+    {
+        free( file->data );
+    }
+    vector_delete( file->faces );
+    free( file->filename );
+    free( file );
+    if( !vector_size( font_registry_files ) )
+    {
+        vector_delete( font_registry_files );
+        font_registry_files = NULL;
+    }
+}
+
+
+// ------------------------------------------------ font_registry_open_face ---
+font_face_t *
+font_registry_open_face( font_file_t * file,
+                         FT_Library library )
+{
+    font_face_t *face;
+    FT_Error error;
+    size_t i;
+
+    assert( file );
+    assert( library );
+
+    for( i=0; i<vector_size( file->faces ); ++i )
+    {
+        face = *(font_face_t **) vector_get( file->faces, i );
+        if( face->library == library )
+        {
+            face->refcount++;
+            return face;
+        }
+    }
+
+    face = (font_face_t *) calloc( 1, sizeof(font_face_t) );
+    if( face == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    error = FT_New_Memory_Face( library, file->data, (FT_Long) file->size,
+                                0, &face->face );
+    if( !error )
+    {
+        error = FT_Select_Charmap( face->face, FT_ENCODING_UNICODE );
+        if( error )
+        {
+            FT_Done_Face( face->face );
+        }
+    }
+    if( error )
+    {
+        fprintf( stderr, "FT_Error (line %d, code 0x%02x)\n", __LINE__, error );
+        free( face );
+        return NULL;
+    }
+    face->library = library;
+    face->refcount = 1;
+    vector_push_back( file->faces, &face );
+    return face;
+}
+
+
+// ----------------------------------------------- font_registry_close_face ---
+void
+font_registry_close_face( font_file_t * file,
+                          font_face_t * face )
+{
+    size_t i;
+
+    assert( file );
+    assert( face );
+
+    if( --face->refcount )
+    {
+        return;
+    }
+    for( i=0; i<vector_size( file->faces ); ++i )
+    {
+        if( *(font_face_t **) vector_get( file->faces, i ) == face )
+        {
+            vector_erase( file->faces, i );
+            break;
+        }
+    }
+    // Sizes of the fonts using the face are released as well
+    FT_Done_Face( face->face );
+    for( i=0; i<256; ++i )
+    {
+        free( face->indices[i] );
+    }
+    if( face->kerning_pairs )
+    {
+        vector_delete( face->kerning_pairs );
+    }
+    free( face );
+}
+
+
+// ---------------------------------------------- font_registry_glyph_index ---
+FT_UInt
+font_registry_glyph_index( font_face_t * face,
+                           wchar_t charcode )
+{
+    FT_UInt *block;
+    size_t code = (size_t) charcode;
+
+    assert( face );
+
+    if( code > 0xffff )
+    {
+        return FT_Get_Char_Index( face->face, charcode );
+    }
+    block = face->indices[code >> 8];
+    if( !block )
+    {
+        block = (FT_UInt *) calloc( 256, sizeof(FT_UInt) );
+        if( block == NULL )
+        {
+            fprintf( stderr,
+                     "line %d: No more memory for allocating data\n", __LINE__ );
+            exit( EXIT_FAILURE );
+        }
+        face->indices[code >> 8] = block;
+    }
+    if( !block[code & 0xff] )
+    {
+        block[code & 0xff] = FT_Get_Char_Index( face->face, charcode ) + 1;
+    }
+    return block[code & 0xff] - 1;
+}
+
+
+// ---------------------------------------------- font_registry_get_library ---
+FT_Library
+font_registry_get_library( void )
+{
+    FT_Error error;
+
+    if( !font_registry_library )
+    {
+        error = FT_Init_FreeType( &font_registry_library );
+        if( error )
+        {
+            fprintf( stderr, "FT_Error (line %d, code 0x%02x)\n",
+                     __LINE__, error );
+            font_registry_library = NULL;
+            return NULL;
+        }
+    }
+    font_registry_library_count++;
+    return font_registry_library;
+}
+
+
+// ------------------------------------------ font_registry_release_library ---
+void
+font_registry_release_library( void )
+{
+    assert( font_registry_library_count );
+
+    if( --font_registry_library_count )
+    {
+        return;
+    }
+    FT_Done_FreeType( font_registry_library );
+    font_registry_library = NULL;
+}
+
+
+// ------------------------------------------------- font_registry_resident ---
+size_t
+font_registry_resident( const font_file_t * file )
+{
+    assert( file );
+
+    if( !file->mapped )
+    {
+        return file->size;
+    }
+    return platform_resident_size( file->data, file->size );
+}
+
+
+// ---------------------------------------------------- font_registry_count ---
+size_t
+font_registry_count( void )
+{
+    return font_registry_files ? vector_size( font_registry_files ) : 0;
+}
+
+
+// ------------------------------------------------------ font_registry_get ---
+font_file_t *
+font_registry_get( size_t index )
+{
+    assert( index < font_registry_count( ) );
+
+    return *(font_file_t **) vector_get( font_registry_files, index );
+}
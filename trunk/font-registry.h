@@ -0,0 +1,266 @@
+/* ============================================================================
+ * Freetype GL - A C OpenGL Freetype engine
+ * Platform:    Any
+ * WWW:         http://code.google.com/p/freetype-gl/
+ * ----------------------------------------------------------------------------
+ * Copyright 2011,2012 Nicolas P. Rougier. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  1. Redistributions of source code must retain the above copyright notice,
+ *     this list of conditions and the following disclaimer.
+ *
+ *  2. Redistributions in binary form must reproduce the above copyright
+ *     notice, this list of conditions and the following disclaimer in the
+ *     documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY NICOLAS P. ROUGIER ''AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL NICOLAS P. ROUGIER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+ * INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ * The views and conclusions contained in the software and documentation are
+ * those of the authors and should not be interpreted as representing official
+ * policies, either expressed or implied, of Nicolas P. Rougier.
+ * ============================================================================
+ */
+#ifndef __FONT_REGISTRY_H__
+#define __FONT_REGISTRY_H__
+
+#include <stdlib.h>
+#include <wchar.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include "vector.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**
+ * @file   font-registry.h
+ *
+ * @defgroup font-registry Font registry
+ *
+ * Font files shared by all the texture fonts of a program. Each file is
+ * mapped in memory once (or read if it cannot be mapped) and a single face
+ * per freetype library is created from these bytes, whatever the number of
+ * sizes and outline variants in use (each font having its own FT_Size). The
+ * registry is not thread safe: fonts must be created and deleted from a
+ * single thread.
+ *
+ * <b>Example Usage</b>:
+ * @code
+ * #include "font-registry.h"
+ *
+ * int main( int arrgc, char *argv[] )
+ * {
+ *     font_file_t * file = font_registry_open( "Vera.ttf" );
+ *     printf( "%d bytes resident\n", (int) font_registry_resident( file ) );
+ *     font_registry_close( file );
+ *
+ *     return 0;
+ * }
+ * @endcode
+ *
+ * @{
+ */
+
+
+/**
+ * A face shared by the fonts of a file using the same freetype library.
+ */
+typedef struct
+{
+    /**
+     * Freetype library the face belongs to
+     */
+    FT_Library library;
+
+    /**
+     * Freetype face (unicode charmap selected)
+     */
+    FT_Face face;
+
+    /**
+     * Glyph indices of the basic multilingual plane charcodes, by blocks
+     * of 256 allocated on first lookup. Indices are stored plus one, 0
+     * meaning not looked up yet.
+     */
+    FT_UInt * indices[256];
+
+    /**
+     * Glyph index pairs (ivec2) listed in the font kerning table, loaded
+     * the first time a large batch of glyphs needs kerning (see
+     * texture_font_get_kerning_pairs).
+     */
+    vector_t * kerning_pairs;
+
+    /**
+     * Number of fonts using the face
+     */
+    size_t refcount;
+
+} font_face_t;
+
+
+/**
+ * A font file content shared by several faces.
+ */
+typedef struct
+{
+    /**
+     * Font filename (as given to font_registry_open)
+     */
+    char * filename;
+
+    /**
+     * File content
+     */
+    unsigned char * data;
+
+    /**
+     * File size in bytes
+     */
+    size_t size;
+
+    /**
+     * Whether data is a file mapping (it is a malloc'ed copy otherwise)
+     */
+    int mapped;
+
+    /**
+     * Number of users of the file, the file is closed when it gets to 0
+     */
+    size_t refcount;
+
+    /**
+     * Faces (font_face_t *) created from the file, one per library
+     */
+    vector_t * faces;
+
+} font_file_t;
+
+
+
+/**
+ * Get a font file, opening it if it is not in use yet.
+ *
+ * @param filename font filename
+ *
+ * @return the shared font file or NULL if it cannot be read
+ */
+  font_file_t *
+  font_registry_open( const char * filename );
+
+
+/**
+ * Release a font file got from font_registry_open.
+ *
+ * @param file a font file
+ */
+  void
+  font_registry_close( font_file_t * file );
+
+
+/**
+ * Get the face of a font file for a given library, creating it if it is
+ * not in use yet. The caller is expected to create its own FT_Size.
+ *
+ * @param file    a font file
+ * @param library a freetype library
+ *
+ * @return the shared face or NULL if it cannot be created
+ */
+  font_face_t *
+  font_registry_open_face( font_file_t * file,
+                           FT_Library library );
+
+
+/**
+ * Release a face got from font_registry_open_face.
+ *
+ * @param file a font file
+ * @param face a face of the file
+ */
+  void
+  font_registry_close_face( font_file_t * file,
+                            font_face_t * face );
+
+
+/**
+ * Get the glyph index of a charcode, looking up the face charmap only once
+ * per charcode of the basic multilingual plane.
+ *
+ * @param face     a shared face
+ * @param charcode character codepoint
+ *
+ * @return the glyph index (0 if the face has no glyph for the charcode)
+ */
+  FT_UInt
+  font_registry_glyph_index( font_face_t * face,
+                             wchar_t charcode );
+
+
+/**
+ * Get the freetype library shared by the fonts created with
+ * texture_font_new (it is created on first call).
+ *
+ * @return a freetype library or NULL if it cannot be initialized
+ */
+  FT_Library
+  font_registry_get_library( void );
+
+
+/**
+ * Release the library got from font_registry_get_library. It is destroyed
+ * when it is no longer used.
+ */
+  void
+  font_registry_release_library( void );
+
+
+/**
+ * Get the number of bytes of a font file that are in physical memory.
+ *
+ * @param file a font file
+ *
+ * @return number of resident bytes (size of the file if it is not mapped
+ *         or if this cannot be known)
+ */
+  size_t
+  font_registry_resident( const font_file_t * file );
+
+
+/**
+ * Get the number of open font files.
+ */
+  size_t
+  font_registry_count( void );
+
+
+/**
+ * Get an open font file.
+ *
+ * @param index index of the file (less than font_registry_count)
+ *
+ * @return a font file
+ */
+  font_file_t *
+  font_registry_get( size_t index );
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __FONT_REGISTRY_H__ */
@@ -32,81 +32,41 @@
  * ============================================================================
  */
 #include "freetype-gl.h"
+#include "font-cache.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <wchar.h>
 
-#if defined(__APPLE__)
-    #include <Glut/glut.h>
-#elif defined(_WIN32) || defined(_WIN64)
-    #include <GLUT/glut.h>
-#else
-    #include <GL/glut.h>
-#endif
 
-// ---------------------------------------------------------------- display ---
-void display( void )
-{}
-
-// ---------------------------------------------------------------- reshape ---
-void reshape(int width, int height)
-{}
-
-// --------------------------------------------------------------- keyboard ---
-void keyboard( unsigned char key, int x, int y )
-{}
-
-
-// ------------------------------------------------------------------- main ---
-int main( int argc, char **argv )
+// ----------------------------------------------------------- write_header ---
+// C header holding the whole font (see demo-makefont.c)
+void write_header( texture_font_t * font, const char * header_filename )
 {
     size_t i, j;
-
-    wchar_t * font_cache = 
-        L" !\"#$%&'()*+,-./0123456789:;<=>?"
-        L"@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_"
-        L"`abcdefghijklmnopqrstuvwxyz{|}~";
-
-    float  font_size   = 16.0;
-    char * font_filename   = "fonts/Arial.ttf";
-    char * header_filename = "arial-16.h";
-
-    texture_atlas_t * atlas = texture_atlas_new( 128, 128, 1 );
-    texture_font_t  * font  = texture_font_new( atlas, font_filename, font_size );
-    
-
-    glutInit( &argc, argv );
-    glutInitWindowSize( atlas->width, atlas->height );
-    glutInitDisplayMode( GLUT_DOUBLE | GLUT_RGB | GLUT_DEPTH );
-    glutCreateWindow( "Freetype OpenGL" );
-    glutReshapeFunc( reshape );
-    glutDisplayFunc( display );
-    glutKeyboardFunc( keyboard );
-
-    size_t missed = texture_font_load_glyphs( font, font_cache );
-
-    wprintf( L"Font filename              : %s\n", font_filename );
-    wprintf( L"Font size                  : %.1f\n", font_size );
-    wprintf( L"Number of glyphs           : %ld\n", wcslen(font_cache) );
-    wprintf( L"Number of missed glyphs    : %ld\n", missed );
-    wprintf( L"Texture size               : %ldx%ldx%ld\n",
-             atlas->width, atlas->height, atlas->depth );
-    wprintf( L"Texture occupancy          : %.2f%%\n", 
-            100.0*atlas->used/(float)(atlas->width*atlas->height) );
-    wprintf( L"\n" );
-    wprintf( L"Header filename            : %s\n", header_filename );
-
+    texture_atlas_t * atlas = font->atlas;
 
     size_t texture_size = atlas->width * atlas->height *atlas->depth;
     size_t glyph_count = font->glyphs->size;
     size_t max_kerning_count = 1;
+    kerning_table_t *kerning_table = font->kerning_table;
     for( i=0; i < glyph_count; ++i )
     {
         texture_glyph_t *glyph = *(texture_glyph_t **) vector_get( font->glyphs, i );
+        size_t kerning_count = 0;
 
-        if( vector_size(glyph->kerning) > max_kerning_count )
+        for( j=0; j < glyph_count; ++j )
+        {
+            texture_glyph_t *left = *(texture_glyph_t **) vector_get( font->glyphs, j );
+            if( kerning_table_get( kerning_table, left->charcode, glyph->charcode ) )
+            {
+                ++kerning_count;
+            }
+        }
+        if( kerning_count > max_kerning_count )
         {
-            max_kerning_count = vector_size(glyph->kerning);
+            max_kerning_count = kerning_count;
         }
     }
 
@@ -297,22 +257,36 @@ int main( int argc, char **argv )
         fwprintf( file, L"%d, %d, ", glyph->offset_x, glyph->offset_y );
         fwprintf( file, L"%ff, %ff, ", glyph->advance_x, glyph->advance_y );
         fwprintf( file, L"%ff, %ff, %ff, %ff, ", glyph->s0, glyph->t0, glyph->s1, glyph->t1 );
-        fwprintf( file, L"%d, ", vector_size(glyph->kerning) );
+        size_t kerning_count = 0;
+        for( j=0; j < glyph_count; ++j )
+        {
+            texture_glyph_t *left = *(texture_glyph_t **) vector_get( font->glyphs, j );
+            if( kerning_table_get( kerning_table, left->charcode, glyph->charcode ) )
+            {
+                ++kerning_count;
+            }
+        }
+        fwprintf( file, L"%d, ", kerning_count );
         fwprintf( file, L"{ " );
-        for( j=0; j < vector_size(glyph->kerning); ++j )
+        for( j=0; j < glyph_count; ++j )
         {
-            kerning_t *kerning = (kerning_t *) vector_get( glyph->kerning, j);
-            wchar_t charcode = kerning->charcode;
+            texture_glyph_t *left = *(texture_glyph_t **) vector_get( font->glyphs, j );
+            wchar_t charcode = left->charcode;
+            float kerning = kerning_table_get( kerning_table, charcode, glyph->charcode );
 
+            if( !kerning )
+            {
+                continue;
+            }
             if( (charcode == L'\'' ) || (charcode == L'\\') )
             {
-                fwprintf( file, L"{L'\\%lc', %ff}", charcode, kerning->kerning );
+                fwprintf( file, L"{L'\\%lc', %ff}", charcode, kerning );
             }
             else if( (charcode != (wchar_t)(-1) ) )
             {
-                fwprintf( file, L"{L'%lc', %ff}", charcode, kerning->kerning );
+                fwprintf( file, L"{L'%lc', %ff}", charcode, kerning );
             }
-            if( j < (vector_size(glyph->kerning)-1))
+            if( --kerning_count )
             {
                 fwprintf( file, L", " );
             }
@@ -325,6 +299,68 @@ int main( int argc, char **argv )
         L"#ifdef __cplusplus\n"
         L"}\n"
         L"#endif\n" );
+    fclose( file );
+}
+
+
+// ------------------------------------------------------------------- main ---
+int main( int argc, char **argv )
+{
+    wchar_t * font_cache = 
+        L" !\"#$%&'()*+,-./0123456789:;<=>?"
+        L"@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_"
+        L"`abcdefghijklmnopqrstuvwxyz{|}~";
+
+    float  font_size   = 16.0;
+    char * font_filename   = "fonts/Arial.ttf";
+    char * output_filename = "arial-16.h";
+    size_t length;
+
+    // makefont [font file [size [output]]]: output is a C header when its
+    // name ends with ".h" and a binary font cache (see font-cache.h)
+    // otherwise.
+    if( argc > 1 )
+    {
+        font_filename = argv[1];
+    }
+    if( argc > 2 )
+    {
+        font_size = (float) atof( argv[2] );
+    }
+    if( argc > 3 )
+    {
+        output_filename = argv[3];
+    }
+
+    texture_atlas_t * atlas = texture_atlas_new( 128, 128, 1 );
+    // Atlas is only written to a file, no OpenGL context is needed
+    atlas->upload = 0;
+    texture_font_t  * font  = texture_font_new( atlas, font_filename, font_size );
+
+    size_t missed = texture_font_load_glyphs( font, font_cache );
+
+    wprintf( L"Font filename              : %s\n", font_filename );
+    wprintf( L"Font size                  : %.1f\n", font_size );
+    wprintf( L"Number of glyphs           : %ld\n", wcslen(font_cache) );
+    wprintf( L"Number of missed glyphs    : %ld\n", missed );
+    wprintf( L"Texture size               : %ldx%ldx%ld\n",
+             atlas->width, atlas->height, atlas->depth );
+    wprintf( L"Texture occupancy          : %.2f%%\n", 
+            100.0*atlas->used/(float)(atlas->width*atlas->height) );
+    wprintf( L"\n" );
+    wprintf( L"Output filename            : %s\n", output_filename );
+
+    length = strlen( output_filename );
+    if( (length > 2) && !strcmp( output_filename + length - 2, ".h" ) )
+    {
+        write_header( font, output_filename );
+    }
+    else if( !font_cache_save( font, output_filename ) )
+    {
+        return EXIT_FAILURE;
+    }
 
+    texture_font_delete( font );
+    texture_atlas_delete( atlas );
     return 0;
 }
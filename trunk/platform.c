@@ -31,6 +31,7 @@
  * policies, either expressed or implied, of Nicolas P. Rougier.
  * ============================================================================
  */
+#include <stdio.h>
 #include <string.h>
 #include "platform.h"
 
@@ -63,3 +64,284 @@ char *strndup( const char *s1, size_t n)
     return copy;
 };
 #endif
+
+
+// Threads: function given to platform_thread_create and its argument
+typedef struct
+{
+    void (*func)( void * );
+    void * data;
+} platform_thread_start_t;
+
+#if defined(_WIN32) || defined(_WIN64)
+
+DWORD WINAPI platform_thread_main( LPVOID start )
+{
+    platform_thread_start_t run = *(platform_thread_start_t *) start;
+    free( start );
+    run.func( run.data );
+    return 0;
+}
+
+int platform_thread_create( platform_thread_t * thread,
+                            void (*func)( void * ), void * data )
+{
+    platform_thread_start_t *start =
+        (platform_thread_start_t *) malloc( sizeof(platform_thread_start_t) );
+    if( start == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    start->func = func;
+    start->data = data;
+    *thread = CreateThread( NULL, 0, platform_thread_main, start, 0, NULL );
+    if( *thread == NULL )
+    {
+        free( start );
+        return 0;
+    }
+    return 1;
+}
+
+void platform_thread_join( platform_thread_t thread )
+{
+    WaitForSingleObject( thread, INFINITE );
+    CloseHandle( thread );
+}
+
+void platform_mutex_init( platform_mutex_t * mutex )
+{
+    InitializeCriticalSection( mutex );
+}
+
+void platform_mutex_lock( platform_mutex_t * mutex )
+{
+    EnterCriticalSection( mutex );
+}
+
+void platform_mutex_unlock( platform_mutex_t * mutex )
+{
+    LeaveCriticalSection( mutex );
+}
+
+void platform_mutex_destroy( platform_mutex_t * mutex )
+{
+    DeleteCriticalSection( mutex );
+}
+
+void platform_cond_init( platform_cond_t * cond )
+{
+    InitializeConditionVariable( cond );
+}
+
+void platform_cond_wait( platform_cond_t * cond, platform_mutex_t * mutex )
+{
+    SleepConditionVariableCS( cond, mutex, INFINITE );
+}
+
+void platform_cond_signal( platform_cond_t * cond )
+{
+    WakeConditionVariable( cond );
+}
+
+void platform_cond_destroy( platform_cond_t * cond )
+{
+}
+
+void * platform_map_file( const char * filename, size_t * size )
+{
+    HANDLE file, mapping;
+    LARGE_INTEGER file_size;
+    void * data = NULL;
+
+    file = CreateFileA( filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+    if( file == INVALID_HANDLE_VALUE )
+    {
+        return NULL;
+    }
+    if( GetFileSizeEx( file, &file_size ) && file_size.QuadPart )
+    {
+        mapping = CreateFileMapping( file, NULL, PAGE_READONLY, 0, 0, NULL );
+        if( mapping )
+        {
+            // The view keeps the mapping alive
+            data = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+            CloseHandle( mapping );
+        }
+        *size = (size_t) file_size.QuadPart;
+    }
+    CloseHandle( file );
+    return data;
+}
+
+void platform_unmap_file( void * data, size_t size )
+{
+    UnmapViewOfFile( data );
+}
+
+size_t platform_resident_size( const void * data, size_t size )
+{
+    return size;
+}
+
+double platform_time( void )
+{
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter( &counter );
+    QueryPerformanceFrequency( &frequency );
+    return counter.QuadPart / (double) frequency.QuadPart;
+}
+
+#else
+
+void * platform_thread_main( void * start )
+{
+    platform_thread_start_t run = *(platform_thread_start_t *) start;
+    free( start );
+    run.func( run.data );
+    return NULL;
+}
+
+int platform_thread_create( platform_thread_t * thread,
+                            void (*func)( void * ), void * data )
+{
+    platform_thread_start_t *start =
+        (platform_thread_start_t *) malloc( sizeof(platform_thread_start_t) );
+    if( start == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    start->func = func;
+    start->data = data;
+    if( pthread_create( thread, NULL, platform_thread_main, start ) )
+    {
+        free( start );
+        return 0;
+    }
+    return 1;
+}
+
+void platform_thread_join( platform_thread_t thread )
+{
+    pthread_join( thread, NULL );
+}
+
+void platform_mutex_init( platform_mutex_t * mutex )
+{
+    pthread_mutex_init( mutex, NULL );
+}
+
+void platform_mutex_lock( platform_mutex_t * mutex )
+{
+    pthread_mutex_lock( mutex );
+}
+
+void platform_mutex_unlock( platform_mutex_t * mutex )
+{
+    pthread_mutex_unlock( mutex );
+}
+
+void platform_mutex_destroy( platform_mutex_t * mutex )
+{
+    pthread_mutex_destroy( mutex );
+}
+
+void platform_cond_init( platform_cond_t * cond )
+{
+    pthread_cond_init( cond, NULL );
+}
+
+void platform_cond_wait( platform_cond_t * cond, platform_mutex_t * mutex )
+{
+    pthread_cond_wait( cond, mutex );
+}
+
+void platform_cond_signal( platform_cond_t * cond )
+{
+    pthread_cond_signal( cond );
+}
+
+void platform_cond_destroy( platform_cond_t * cond )
+{
+    pthread_cond_destroy( cond );
+}
+
+void * platform_map_file( const char * filename, size_t * size )
+{
+    struct stat info;
+    void * data = NULL;
+    int fd;
+
+    fd = open( filename, O_RDONLY );
+    if( fd < 0 )
+    {
+        return NULL;
+    }
+    if( !fstat( fd, &info ) && info.st_size )
+    {
+        data = mmap( NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+        if( data == MAP_FAILED )
+        {
+            data = NULL;
+        }
+        *size = (size_t) info.st_size;
+    }
+    // The mapping keeps the file alive
+    close( fd );
+    return data;
+}
+
+void platform_unmap_file( void * data, size_t size )
+{
+    munmap( data, size );
+}
+
+size_t platform_resident_size( const void * data, size_t size )
+{
+    size_t i, pages, page_size = (size_t) sysconf( _SC_PAGESIZE );
+    size_t resident = 0;
+#if defined(__APPLE__)
+    char *vec;
+#else
+    unsigned char *vec;
+#endif
+
+    pages = (size + page_size - 1) / page_size;
+    vec = malloc( pages );
+    if( vec == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    if( mincore( (void *) data, size, vec ) )
+    {
+        free( vec );
+        return size;
+    }
+    for( i=0; i<pages; ++i )
+    {
+        resident += (vec[i] & 1) ? page_size : 0;
+    }
+    // Last page is only partly used by the file
+    if( vec[pages-1] & 1 )
+    {
+        resident -= pages*page_size - size;
+    }
+    free( vec );
+    return resident;
+}
+
+double platform_time( void )
+{
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+#endif
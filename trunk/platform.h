@@ -48,6 +48,30 @@ typedef unsigned __int64 uint64_t;
 #include <stdint.h>
 #endif // _MSC_VER
 
+//-------------------------------------------------
+// Threads (used for background glyph rasterization) and file mapping
+//-------------------------------------------------
+#if defined(_WIN32) || defined(_WIN64)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+typedef HANDLE platform_thread_t;
+typedef CRITICAL_SECTION platform_mutex_t;
+typedef CONDITION_VARIABLE platform_cond_t;
+#else
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+typedef pthread_t platform_thread_t;
+typedef pthread_mutex_t platform_mutex_t;
+typedef pthread_cond_t platform_cond_t;
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -62,6 +86,32 @@ extern "C" {
 #    pragma warning (disable: 4244) // suspend warnings
 #endif // _WIN32 || _WIN64
 
+    /* Start func(data) in a new thread, returns 0 on failure */
+    int platform_thread_create( platform_thread_t * thread,
+                                void (*func)( void * ), void * data );
+    void platform_thread_join( platform_thread_t thread );
+
+    void platform_mutex_init( platform_mutex_t * mutex );
+    void platform_mutex_lock( platform_mutex_t * mutex );
+    void platform_mutex_unlock( platform_mutex_t * mutex );
+    void platform_mutex_destroy( platform_mutex_t * mutex );
+
+    void platform_cond_init( platform_cond_t * cond );
+    void platform_cond_wait( platform_cond_t * cond, platform_mutex_t * mutex );
+    void platform_cond_signal( platform_cond_t * cond );
+    void platform_cond_destroy( platform_cond_t * cond );
+
+    /* Map a whole file read-only in memory, returns NULL on failure */
+    void * platform_map_file( const char * filename, size_t * size );
+    void platform_unmap_file( void * data, size_t size );
+
+    /* Number of bytes of a mapping that are currently in physical memory
+     * (mapping size where this cannot be queried) */
+    size_t platform_resident_size( const void * data, size_t size );
+
+    /* Monotonic wall clock in seconds, for timings */
+    double platform_time( void );
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
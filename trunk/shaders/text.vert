@@ -40,7 +40,7 @@ uniform mat4 projection;
 
 attribute vec3 vertex;
 attribute vec4 color;
-attribute vec2 tex_coord;
+attribute vec3 tex_coord;
 attribute float ashift;
 attribute float agamma;
 varying float vshift;
@@ -50,6 +50,6 @@ void main()
     vshift = ashift;
     vgamma = agamma;
     gl_FrontColor = color;
-    gl_TexCoord[0].xy = tex_coord.xy;
+    gl_TexCoord[0].xyz = tex_coord.xyz;
     gl_Position = projection*(view*(model*vec4(vertex,1.0)));
 }
@@ -36,29 +36,47 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <assert.h>
+#include <math.h>
 #include "opengl.h"
 #include "text-buffer.h"
 
 
-#define SET_GLYPH_VERTEX(value,x0,y0,z0,s0,t0,r,g,b,a,sh,gm) { \
+#define SET_GLYPH_VERTEX(value,x0,y0,z0,s0,t0,p0,r,g,b,a,sh,gm) { \
 	glyph_vertex_t *gv=&value;                                 \
 	gv->x=x0; gv->y=y0; gv->z=z0;                              \
-	gv->u=s0; gv->v=t0;                                        \
+	gv->u=s0; gv->v=t0; gv->w=p0;                              \
 	gv->r=r; gv->g=g; gv->b=b; gv->a=a;                        \
 	gv->shift=sh; gv->gamma=gm;}
 
 
 // ----------------------------------------------------------------------------
+// Text buffer with atlas pages and glyph subpixel phases (see
+// text_buffer_new_with_pages and text_buffer_new_with_phases)
 text_buffer_t *
-text_buffer_new( size_t depth )
+text_buffer_new_with_options( size_t depth, size_t pages, size_t phases )
 {
     
     text_buffer_t *self = (text_buffer_t *) malloc (sizeof(text_buffer_t));
     self->buffer = vertex_buffer_new(
-        "vertex:3f,tex_coord:2f,color:4f,ashift:1f,agamma:1f" );
+        "vertex:3f,tex_coord:3f,color:4f,ashift:1f,agamma:1f" );
     self->manager = font_manager_new( 512, 512, depth );
-    self->shader = shader_load("shaders/text.vert",
-                               "shaders/text.frag");
+    self->manager->atlas->max_pages = pages;
+    self->manager->subpixel_phases = phases;
+    if( phases > 1 )
+    {
+        self->shader = shader_load("shaders/text.vert",
+                                   "shaders/text-phase.frag");
+    }
+    else if( pages > 1 )
+    {
+        self->shader = shader_load("shaders/text.vert",
+                                   "shaders/text-array.frag");
+    }
+    else
+    {
+        self->shader = shader_load("shaders/text.vert",
+                                   "shaders/text.frag");
+    }
     self->shader_texture = glGetUniformLocation(self->shader, "texture");
     self->shader_pixel = glGetUniformLocation(self->shader, "pixel");
     self->line_start = 0;
@@ -71,6 +89,27 @@ text_buffer_new( size_t depth )
     return self;
 }
 
+// ----------------------------------------------------------------------------
+text_buffer_t *
+text_buffer_new( size_t depth )
+{
+    return text_buffer_new_with_options( depth, 1, 0 );
+}
+
+// ----------------------------------------------------------------------------
+text_buffer_t *
+text_buffer_new_with_pages( size_t depth, size_t pages )
+{
+    return text_buffer_new_with_options( depth, pages, 0 );
+}
+
+// ----------------------------------------------------------------------------
+text_buffer_t *
+text_buffer_new_with_phases( size_t depth, size_t phases )
+{
+    return text_buffer_new_with_options( depth, 1, phases );
+}
+
 // ----------------------------------------------------------------------------
 void
 text_buffer_clear( text_buffer_t * self )
@@ -89,8 +128,20 @@ void
 text_buffer_render( text_buffer_t * self )
 {
     glEnable( GL_BLEND );
-    glEnable( GL_TEXTURE_2D );
-    glBindTexture( GL_TEXTURE_2D, self->manager->atlas->id );
+#ifdef GL_TEXTURE_2D_ARRAY
+    if( self->manager->atlas->max_pages > 1 )
+    {
+        // All pages are drawn at once, page being the third texture coordinate
+        glBindTexture( GL_TEXTURE_2D_ARRAY, self->manager->atlas->id );
+    }
+    else
+#else
+    assert( self->manager->atlas->max_pages == 1 );
+#endif
+    {
+        glEnable( GL_TEXTURE_2D );
+        glBindTexture( GL_TEXTURE_2D, self->manager->atlas->id );
+    }
     if( self->manager->atlas->depth == 1 )
     {
         //glDisable( GL_COLOR_MATERIAL );
@@ -281,15 +332,16 @@ text_buffer_add_wchar( text_buffer_t * self,
         float t0 = black->t0;
         float s1 = black->s1;
         float t1 = black->t1;
+        float p  = black->page;
 
         SET_GLYPH_VERTEX(vertices[vcount+0],
-                         (int)x0,y0,0,  s0,t0,  r,g,b,a,  x0-((int)x0), gamma );
+                         (int)x0,y0,0,  s0,t0,p,  r,g,b,a,  x0-((int)x0), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+1],
-                         (int)x0,y1,0,  s0,t1,  r,g,b,a,  x0-((int)x0), gamma );
+                         (int)x0,y1,0,  s0,t1,p,  r,g,b,a,  x0-((int)x0), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+2],
-                         (int)x1,y1,0,  s1,t1,  r,g,b,a,  x1-((int)x1), gamma );
+                         (int)x1,y1,0,  s1,t1,p,  r,g,b,a,  x1-((int)x1), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+3],
-                         (int)x1,y0,0,  s1,t0,  r,g,b,a,  x1-((int)x1), gamma );
+                         (int)x1,y0,0,  s1,t0,p,  r,g,b,a,  x1-((int)x1), gamma );
         indices[icount + 0] = vcount+0;
         indices[icount + 1] = vcount+1;
         indices[icount + 2] = vcount+2;
@@ -315,15 +367,16 @@ text_buffer_add_wchar( text_buffer_t * self,
         float t0 = black->t0;
         float s1 = black->s1;
         float t1 = black->t1;
+        float p  = black->page;
 
         SET_GLYPH_VERTEX(vertices[vcount+0],
-                         (int)x0,y0,0,  s0,t0,  r,g,b,a,  x0-((int)x0), gamma );
+                         (int)x0,y0,0,  s0,t0,p,  r,g,b,a,  x0-((int)x0), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+1],
-                         (int)x0,y1,0,  s0,t1,  r,g,b,a,  x0-((int)x0), gamma );
+                         (int)x0,y1,0,  s0,t1,p,  r,g,b,a,  x0-((int)x0), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+2],
-                         (int)x1,y1,0,  s1,t1,  r,g,b,a,  x1-((int)x1), gamma );
+                         (int)x1,y1,0,  s1,t1,p,  r,g,b,a,  x1-((int)x1), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+3],
-                         (int)x1,y0,0,  s1,t0,  r,g,b,a,  x1-((int)x1), gamma );
+                         (int)x1,y0,0,  s1,t0,p,  r,g,b,a,  x1-((int)x1), gamma );
         indices[icount + 0] = vcount+0;
         indices[icount + 1] = vcount+1;
         indices[icount + 2] = vcount+2;
@@ -349,14 +402,15 @@ text_buffer_add_wchar( text_buffer_t * self,
         float t0 = black->t0;
         float s1 = black->s1;
         float t1 = black->t1;
+        float p  = black->page;
         SET_GLYPH_VERTEX(vertices[vcount+0],
-                         (int)x0,y0,0,  s0,t0,  r,g,b,a,  x0-((int)x0), gamma );
+                         (int)x0,y0,0,  s0,t0,p,  r,g,b,a,  x0-((int)x0), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+1],
-                         (int)x0,y1,0,  s0,t1,  r,g,b,a,  x0-((int)x0), gamma );
+                         (int)x0,y1,0,  s0,t1,p,  r,g,b,a,  x0-((int)x0), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+2],
-                         (int)x1,y1,0,  s1,t1,  r,g,b,a,  x1-((int)x1), gamma );
+                         (int)x1,y1,0,  s1,t1,p,  r,g,b,a,  x1-((int)x1), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+3],
-                         (int)x1,y0,0,  s1,t0,  r,g,b,a,  x1-((int)x1), gamma );
+                         (int)x1,y0,0,  s1,t0,p,  r,g,b,a,  x1-((int)x1), gamma );
         indices[icount + 0] = vcount+0;
         indices[icount + 1] = vcount+1;
         indices[icount + 2] = vcount+2;
@@ -382,14 +436,15 @@ text_buffer_add_wchar( text_buffer_t * self,
         float t0 = black->t0;
         float s1 = black->s1;
         float t1 = black->t1;
+        float p  = black->page;
         SET_GLYPH_VERTEX(vertices[vcount+0],
-                         (int)x0,y0,0,  s0,t0,  r,g,b,a,  x0-((int)x0), gamma );
+                         (int)x0,y0,0,  s0,t0,p,  r,g,b,a,  x0-((int)x0), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+1],
-                         (int)x0,y1,0,  s0,t1,  r,g,b,a,  x0-((int)x0), gamma );
+                         (int)x0,y1,0,  s0,t1,p,  r,g,b,a,  x0-((int)x0), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+2],
-                         (int)x1,y1,0,  s1,t1,  r,g,b,a,  x1-((int)x1), gamma );
+                         (int)x1,y1,0,  s1,t1,p,  r,g,b,a,  x1-((int)x1), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+3],
-                         (int)x1,y0,0,  s1,t0,  r,g,b,a,  x1-((int)x1), gamma );
+                         (int)x1,y0,0,  s1,t0,p,  r,g,b,a,  x1-((int)x1), gamma );
         indices[icount + 0] = vcount+0;
         indices[icount + 1] = vcount+1;
         indices[icount + 2] = vcount+2;
@@ -405,23 +460,51 @@ text_buffer_add_wchar( text_buffer_t * self,
         float g = markup->foreground_color.green;
         float b = markup->foreground_color.blue;
         float a = markup->foreground_color.alpha;
-        float x0 = ( pen->x + glyph->offset_x );
-        float y0 = (int)( pen->y + glyph->offset_y );
-        float x1 = ( x0 + glyph->width );
-        float y1 = (int)( y0 - glyph->height );
-        float s0 = glyph->s0;
-        float t0 = glyph->t0;
-        float s1 = glyph->s1;
-        float t1 = glyph->t1;
+        float x0, y0, x1, y1, s0, t0, s1, t1, p;
+        texture_glyph_t *variant = glyph;
+
+        // Glyph rasterized at the phase nearest to the pen is drawn at a
+        // whole pixel (multi-channel distance fields have a single phase
+        // and are drawn at the exact pen position)
+        if( (font->subpixel_phases > 1) &&
+            (font->render_mode != TEXTURE_FONT_MULTI_DISTANCE_FIELD) )
+        {
+            float x = floor( pen->x );
+            font->phase = (int)( (pen->x - x) * font->subpixel_phases + .5 );
+            if( font->phase == (int) font->subpixel_phases )
+            {
+                font->phase = 0;
+                x += 1;
+            }
+            variant = texture_font_get_glyph( font, current );
+            font->phase = 0;
+            if( variant == NULL )
+            {
+                variant = glyph;
+            }
+            x0 = x + variant->offset_x;
+        }
+        else
+        {
+            x0 = pen->x + glyph->offset_x;
+        }
+        y0 = (int)( pen->y + variant->offset_y );
+        x1 = ( x0 + variant->width );
+        y1 = (int)( y0 - variant->height );
+        s0 = variant->s0;
+        t0 = variant->t0;
+        s1 = variant->s1;
+        t1 = variant->t1;
+        p  = variant->page;
 
         SET_GLYPH_VERTEX(vertices[vcount+0],
-                         (int)x0,y0,0,  s0,t0,  r,g,b,a,  x0-((int)x0), gamma );
+                         (int)x0,y0,0,  s0,t0,p,  r,g,b,a,  x0-((int)x0), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+1],
-                         (int)x0,y1,0,  s0,t1,  r,g,b,a,  x0-((int)x0), gamma );
+                         (int)x0,y1,0,  s0,t1,p,  r,g,b,a,  x0-((int)x0), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+2],
-                         (int)x1,y1,0,  s1,t1,  r,g,b,a,  x1-((int)x1), gamma );
+                         (int)x1,y1,0,  s1,t1,p,  r,g,b,a,  x1-((int)x1), gamma );
         SET_GLYPH_VERTEX(vertices[vcount+3],
-                         (int)x1,y0,0,  s1,t0,  r,g,b,a,  x1-((int)x1), gamma );
+                         (int)x1,y0,0,  s1,t0,p,  r,g,b,a,  x1-((int)x1), gamma );
         indices[icount + 0] = vcount+0;
         indices[icount + 1] = vcount+1;
         indices[icount + 2] = vcount+2;
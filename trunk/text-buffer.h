@@ -163,6 +163,11 @@ typedef struct {
      */
     float v;
 
+    /**
+     * Texture third coordinate (atlas page)
+     */
+    float w;
+
     /**
      * Color red component
      */
@@ -209,6 +214,50 @@ typedef struct {
   text_buffer_new( size_t depth );
 
 
+/**
+ * Creates a new empty text buffer whose atlas is made of several pages
+ * (texture array). Requires OpenGL 3.0 or GL_EXT_texture_array.
+ *
+ * @param depth  Underlying atlas bit depth (1 or 3)
+ * @param pages  Maximum number of atlas pages
+ *
+ * @return  a new empty text buffer.
+ *
+ */
+  text_buffer_t *
+  text_buffer_new_with_pages( size_t depth, size_t pages );
+
+
+/**
+ * Creates a new empty text buffer whose glyphs are rasterized at several
+ * horizontal subpixel phases, each glyph being drawn from the phase
+ * nearest to its position (the shader then reads a single texel).
+ *
+ * @param depth  Underlying atlas bit depth (1 or 3)
+ * @param phases Number of subpixel phases (3 or 4 are good values)
+ *
+ * @return  a new empty text buffer.
+ *
+ */
+  text_buffer_t *
+  text_buffer_new_with_phases( size_t depth, size_t phases );
+
+
+/**
+ * Creates a new empty text buffer with both atlas pages and subpixel
+ * phases (see text_buffer_new_with_pages and text_buffer_new_with_phases).
+ *
+ * @param depth  Underlying atlas bit depth (1 or 3)
+ * @param pages  Maximum number of atlas pages
+ * @param phases Number of subpixel phases (0 or 1 for none)
+ *
+ * @return  a new empty text buffer.
+ *
+ */
+  text_buffer_t *
+  text_buffer_new_with_options( size_t depth, size_t pages, size_t phases );
+
+
 /**
  * Render a text buffer.
  *
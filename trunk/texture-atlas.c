@@ -37,8 +37,38 @@
 #include <assert.h>
 #include <limits.h>
 #include "opengl.h"
+#include "platform.h"
 #include "texture-atlas.h"
 
+// Estimated cost of an upload call, expressed in texels. Two dirty regions
+// are merged whenever their bounding box wastes less than that and the whole
+// atlas is uploaded when this is cheaper than uploading every dirty region.
+#define UPLOAD_OVERHEAD 4096
+
+// Default maximum size an atlas can grow to when it is full
+#define MAX_SIZE 4096
+
+
+// ------------------------------------------------ texture_atlas_init_page ---
+void
+texture_atlas_init_page( texture_atlas_t * self,
+                         const size_t page )
+{
+    // We want a one pixel border around the whole atlas to avoid any artefact when
+    // sampling texture
+    if( self->packer == TEXTURE_ATLAS_SKYLINE )
+    {
+        ivec3 node = {{1, page*self->height + 1, self->width-2}};
+        vector_push_back( self->nodes, &node );
+    }
+    else if( self->packer != TEXTURE_ATLAS_SHELF )
+    {
+        ivec4 rect = {{1, page*self->height + 1, self->width-2, self->height-2}};
+        vector_push_back( self->nodes, &rect );
+    }
+    // Shelves are opened on demand
+}
+
 
 // ------------------------------------------------------ texture_atlas_new ---
 texture_atlas_t *
@@ -46,11 +76,19 @@ texture_atlas_new( const size_t width,
                    const size_t height,
                    const size_t depth )
 {
-    texture_atlas_t *self = (texture_atlas_t *) malloc( sizeof(texture_atlas_t) );
+    return texture_atlas_new_with_packer( width, height, depth,
+                                          TEXTURE_ATLAS_SKYLINE );
+}
 
-    // We want a one pixel border around the whole atlas to avoid any artefact when
-    // sampling texture
-    ivec3 node = {{1,1,width-2}};
+
+// ------------------------------------------ texture_atlas_new_with_packer ---
+texture_atlas_t *
+texture_atlas_new_with_packer( const size_t width,
+                               const size_t height,
+                               const size_t depth,
+                               const int packer )
+{
+    texture_atlas_t *self = (texture_atlas_t *) malloc( sizeof(texture_atlas_t) );
 
     assert( (depth == 1) || (depth == 3) || (depth == 4) );
     if( self == NULL)
@@ -59,14 +97,36 @@ texture_atlas_new( const size_t width,
                  "line %d: No more memory for allocating data\n", __LINE__ );
         exit( EXIT_FAILURE );
     }
-    self->nodes = vector_new( sizeof(ivec3) );
+    self->packer = packer;
+    if( (packer == TEXTURE_ATLAS_MAXRECTS) ||
+        (packer == TEXTURE_ATLAS_GUILLOTINE) )
+    {
+        self->nodes = vector_new( sizeof(ivec4) );
+    }
+    else
+    {
+        self->nodes = vector_new( sizeof(ivec3) );
+    }
     self->used = 0;
+    self->freed = vector_new( sizeof(ivec4) );
+    self->clock = 0;
     self->width = width;
     self->height = height;
     self->depth = depth;
+    self->max_width = width > MAX_SIZE ? width : MAX_SIZE;
+    self->max_height = height > MAX_SIZE ? height : MAX_SIZE;
+    self->page_count = 1;
+    self->max_pages = 1;
+    self->listeners = vector_new( sizeof(texture_atlas_listener_t) );
     self->id = 0;
+    self->dirty = vector_new( sizeof(ivec4) );
+    self->upload_count = 0;
+    self->upload_bytes = 0;
+    self->mapping = NULL;
+    self->mapping_size = 0;
+    self->upload = 1;
 
-    vector_push_back( self->nodes, &node );
+    texture_atlas_init_page( self, 0 );
     self->data = (unsigned char *)
         calloc( width*height*depth, sizeof(unsigned char) );
 
@@ -87,7 +147,14 @@ texture_atlas_delete( texture_atlas_t *self )
 {
     assert( self );
     vector_delete( self->nodes );
-    if( self->data )
+    vector_delete( self->dirty );
+    vector_delete( self->freed );
+    vector_delete( self->listeners );
+    if( self->mapping )
+    {
+        platform_unmap_file( self->mapping, self->mapping_size );
+    }
+    else if( self->data )
     {
         free( self->data );
     }
@@ -99,6 +166,34 @@ texture_atlas_delete( texture_atlas_t *self )
 }
 
 
+// ------------------------------------------------- texture_atlas_own_data ---
+// Data mapped from a font cache is read-only, it is copied before the
+// atlas is first modified.
+void
+texture_atlas_own_data( texture_atlas_t * self )
+{
+    size_t size = self->page_count*self->width*self->height*self->depth;
+    unsigned char *data;
+
+    if( !self->mapping )
+    {
+        return;
+    }
+    data = (unsigned char *) malloc( size );
+    if( data == NULL)
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    memcpy( data, self->data, size );
+    platform_unmap_file( self->mapping, self->mapping_size );
+    self->mapping = NULL;
+    self->mapping_size = 0;
+    self->data = data;
+}
+
+
 // ----------------------------------------------- texture_atlas_set_region ---
 void
 texture_atlas_set_region( texture_atlas_t * self,
@@ -115,12 +210,13 @@ texture_atlas_set_region( texture_atlas_t * self,
 
     assert( self );
     assert( x > 0);
-    assert( y > 0);
+    assert( (y % self->height) > 0);
     assert( x < (self->width-1));
     assert( (x + width) <= (self->width-1));
-    assert( y < (self->height-1));
-    assert( (y + height) <= (self->height-1));
+    assert( y < (self->page_count*self->height));
+    assert( ((y % self->height) + height) <= (self->height-1));
 
+    texture_atlas_own_data( self );
     depth = self->depth;
     charsize = sizeof(char);
     for( i=0; i<height; ++i )
@@ -128,6 +224,12 @@ texture_atlas_set_region( texture_atlas_t * self,
         memcpy( self->data+((y+i)*self->width + x ) * charsize * depth, 
                 data + (i*stride) * charsize, width * charsize * depth  );
     }
+
+    if( width && height )
+    {
+        ivec4 region = {{x, y, width, height}};
+        vector_push_back( self->dirty, &region );
+    }
 }
 
 
@@ -136,19 +238,29 @@ int
 texture_atlas_fit( texture_atlas_t * self,
                    const size_t index,
                    const size_t width,
-                   const size_t height )
+                   const size_t height,
+                   const int limit )
 {
-    ivec3 *node;
-    int x, y, width_left;
+    ivec3 *nodes, *node;
+    int x, y, width_left, top;
 	size_t i;
 
     assert( self );
 
-    node = (ivec3 *) (vector_get( self->nodes, index ));
+    // Nodes are read directly, this is the innermost loop of the packer
+    nodes = (ivec3 *) self->nodes->items;
+    node = nodes + index;
     x = node->x;
 	y = node->y;
     width_left = width;
 	i = index;
+    // Nodes of all pages are stored one after the other, y being offset by
+    // the page index times the atlas height
+    top = (node->y / self->height + 1)*self->height - 1;
+    if( limit < top )
+    {
+        top = limit;
+    }
 
 	if ( (x + width) > (self->width-1) )
     {
@@ -157,12 +269,12 @@ texture_atlas_fit( texture_atlas_t * self,
 	y = node->y;
 	while( width_left > 0 )
 	{
-        node = (ivec3 *) (vector_get( self->nodes, i ));
+        node = nodes + i;
         if( node->y > y )
         {
             y = node->y;
         }
-		if( (y + height) > (self->height-1) )
+		if( (y + (int) height) > top )
         {
 			return -1;
         }
@@ -196,16 +308,331 @@ texture_atlas_merge( texture_atlas_t * self )
 }
 
 
-// ----------------------------------------------- texture_atlas_get_region ---
-ivec4
-texture_atlas_get_region( texture_atlas_t * self,
-                          const size_t width,
-                          const size_t height )
+// ---------------------------------------------------- texture_atlas_grow ---
+int
+texture_atlas_grow( texture_atlas_t * self )
+{
+    size_t width, height;
+
+    assert( self );
+
+    width = self->width;
+    height = self->height;
+
+    // Double the smallest dimension first to keep the atlas squarish
+    if( ((width <= height) && (width < self->max_width)) ||
+        (height >= self->max_height) )
+    {
+        width = 2*width < self->max_width ? 2*width : self->max_width;
+    }
+    else
+    {
+        height = 2*height < self->max_height ? 2*height : self->max_height;
+    }
+    if( (width == self->width) && (height == self->height) )
+    {
+        return 0;
+    }
+    texture_atlas_enlarge( self, width, height );
+    return 1;
+}
+
+
+// ------------------------------------------------ texture_atlas_add_page ---
+int
+texture_atlas_add_page( texture_atlas_t * self )
+{
+    size_t page_size;
+    unsigned char *data;
+
+    assert( self );
+
+    if( self->page_count >= self->max_pages )
+    {
+        return 0;
+    }
+
+    texture_atlas_own_data( self );
+    page_size = self->width*self->height*self->depth;
+    data = (unsigned char *) realloc( self->data, (self->page_count+1)*page_size );
+    if( data == NULL)
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    memset( data + self->page_count*page_size, 0, page_size );
+    self->data = data;
+
+    texture_atlas_init_page( self, self->page_count );
+    self->page_count++;
+
+    // Texture array needs to be reallocated
+    {
+        ivec4 region = {{0, 0, self->width, self->page_count*self->height}};
+        vector_clear( self->dirty );
+        vector_push_back( self->dirty, &region );
+    }
+    return 1;
+}
+
+
+// ---------------------------------------- texture_atlas_guillotine_region ---
+int
+texture_atlas_guillotine_region( vector_t * rects,
+                                 ivec4 * region )
+{
+    size_t i;
+    int best_index = -1, best_area = INT_MAX;
+    int width = region->width, height = region->height;
+    ivec4 free_rect, right, bottom;
+
+    // Smallest free rectangle the region fits in
+    for( i=0; i<vector_size( rects ); ++i )
+    {
+        ivec4 *other = (ivec4 *) rects->items + i;
+        if( (other->width >= width) && (other->height >= height) &&
+            (other->width*other->height < best_area) )
+        {
+            best_index = i;
+            best_area = other->width*other->height;
+        }
+    }
+    if( best_index < 0 )
+    {
+        return 0;
+    }
+    free_rect = *(ivec4 *) vector_get( rects, best_index );
+    vector_erase( rects, best_index );
+
+    // Split what is left along the longest side
+    right.x = free_rect.x + width;
+    right.y = free_rect.y;
+    right.width = free_rect.width - width;
+    bottom.x = free_rect.x;
+    bottom.y = free_rect.y + height;
+    bottom.height = free_rect.height - height;
+    if( right.width > bottom.height )
+    {
+        right.height = free_rect.height;
+        bottom.width = width;
+    }
+    else
+    {
+        right.height = height;
+        bottom.width = free_rect.width;
+    }
+    if( (right.width > 0) && (right.height > 0) )
+    {
+        vector_push_back( rects, &right );
+    }
+    if( (bottom.width > 0) && (bottom.height > 0) )
+    {
+        vector_push_back( rects, &bottom );
+    }
+
+    region->x = free_rect.x;
+    region->y = free_rect.y;
+    return 1;
+}
+
+
+// ------------------------------------------ texture_atlas_maxrects_prune ---
+void
+texture_atlas_maxrects_prune( vector_t * rects,
+                              const size_t first )
+{
+    size_t i, j;
+    ivec4 *a, *b;
+
+    // Free rectangles contained in another one are useless. Rectangles
+    // before first are known not to be contained in one another, nor in
+    // rectangles after first (these are pieces of former rectangles).
+    for( i=first; i<vector_size( rects ); ++i )
+    {
+        a = (ivec4 *) rects->items + i;
+        for( j=0; j<vector_size( rects ); ++j )
+        {
+            b = (ivec4 *) rects->items + j;
+            if( (i != j) &&
+                (a->x >= b->x) && (a->y >= b->y) &&
+                (a->x + a->width <= b->x + b->width) &&
+                (a->y + a->height <= b->y + b->height) )
+            {
+                vector_erase( rects, i );
+                --i;
+                break;
+            }
+        }
+    }
+}
+
+
+// ----------------------------------------- texture_atlas_maxrects_region ---
+int
+texture_atlas_maxrects_region( texture_atlas_t * self,
+                               ivec4 * region )
+{
+    size_t i, count;
+    int best_index = -1, best_short = INT_MAX, best_long = INT_MAX;
+    int width = region->width, height = region->height;
+    int dx, dy, short_side, long_side;
+    ivec4 *rect, used, split;
+
+    assert( self );
+
+    // Best short side fit: smallest leftover on the tightest side
+    for( i=0; i<vector_size( self->nodes ); ++i )
+    {
+        rect = (ivec4 *) self->nodes->items + i;
+        dx = rect->width - width;
+        dy = rect->height - height;
+        if( (dx < 0) || (dy < 0) )
+        {
+            continue;
+        }
+        short_side = dx < dy ? dx : dy;
+        long_side = dx < dy ? dy : dx;
+        if( (short_side < best_short) ||
+            ((short_side == best_short) && (long_side < best_long)) )
+        {
+            best_index = i;
+            best_short = short_side;
+            best_long = long_side;
+        }
+    }
+    if( best_index < 0 )
+    {
+        return 0;
+    }
+    rect = (ivec4 *) vector_get( self->nodes, best_index );
+    used.x = rect->x;
+    used.y = rect->y;
+    used.width = width;
+    used.height = height;
+
+    // Every free rectangle overlapping the new region is replaced by the
+    // (up to four) maximal rectangles around it.
+    count = vector_size( self->nodes );
+    for( i=0; i<count; ++i )
+    {
+        rect = (ivec4 *) vector_get( self->nodes, i );
+        if( (used.x >= rect->x + rect->width) ||
+            (used.x + used.width <= rect->x) ||
+            (used.y >= rect->y + rect->height) ||
+            (used.y + used.height <= rect->y) )
+        {
+            continue;
+        }
+        if( used.x > rect->x )
+        {
+            split = *rect;
+            split.width = used.x - rect->x;
+            vector_push_back( self->nodes, &split );
+            rect = (ivec4 *) vector_get( self->nodes, i );
+        }
+        if( used.x + used.width < rect->x + rect->width )
+        {
+            split = *rect;
+            split.x = used.x + used.width;
+            split.width = rect->x + rect->width - split.x;
+            vector_push_back( self->nodes, &split );
+            rect = (ivec4 *) vector_get( self->nodes, i );
+        }
+        if( used.y > rect->y )
+        {
+            split = *rect;
+            split.height = used.y - rect->y;
+            vector_push_back( self->nodes, &split );
+            rect = (ivec4 *) vector_get( self->nodes, i );
+        }
+        if( used.y + used.height < rect->y + rect->height )
+        {
+            split = *rect;
+            split.y = used.y + used.height;
+            split.height = rect->y + rect->height - split.y;
+            vector_push_back( self->nodes, &split );
+        }
+        vector_erase( self->nodes, i );
+        --i;
+        --count;
+    }
+    texture_atlas_maxrects_prune( self->nodes, count );
+
+    region->x = used.x;
+    region->y = used.y;
+    return 1;
+}
+
+
+// -------------------------------------------- texture_atlas_shelf_region ---
+int
+texture_atlas_shelf_region( texture_atlas_t * self,
+                            ivec4 * region )
 {
+    size_t i, page;
+    int best_index = -1, best_waste = INT_MAX;
+    int width = region->width, height = region->height;
+    int top;
+    ivec3 *shelf;
 
+    assert( self );
+
+    // Shelf whose height is closest to the region one
+    for( i=0; i<vector_size( self->nodes ); ++i )
+    {
+        shelf = (ivec3 *) self->nodes->items + i;
+        if( (shelf->z >= height) &&
+            (shelf->x + width <= (int)(self->width-1)) &&
+            (shelf->z - height < best_waste) )
+        {
+            best_index = i;
+            best_waste = shelf->z - height;
+        }
+    }
+
+    // Open a new shelf on top of the last one of the first page with room
+    for( page=0; (best_index < 0) && (page<self->page_count); ++page )
+    {
+        top = page*self->height + 1;
+        for( i=0; i<vector_size( self->nodes ); ++i )
+        {
+            shelf = (ivec3 *) self->nodes->items + i;
+            if( ((shelf->y / self->height) == page) &&
+                (shelf->y + shelf->z > top) )
+            {
+                top = shelf->y + shelf->z;
+            }
+        }
+        if( (top + height <= (int)((page+1)*self->height - 1)) &&
+            (width <= (int)(self->width-2)) )
+        {
+            ivec3 new_shelf = {{1, top, height}};
+            vector_push_back( self->nodes, &new_shelf );
+            best_index = vector_size( self->nodes ) - 1;
+        }
+    }
+    if( best_index < 0 )
+    {
+        return 0;
+    }
+
+    shelf = (ivec3 *) vector_get( self->nodes, best_index );
+    region->x = shelf->x;
+    region->y = shelf->y;
+    shelf->x += width;
+    return 1;
+}
+
+
+// ------------------------------------------- texture_atlas_skyline_region ---
+int
+texture_atlas_skyline_region( texture_atlas_t * self,
+                              ivec4 * region )
+{
 	int y, best_height, best_width, best_index;
+    int width = region->width, height = region->height;
     ivec3 *node, *prev;
-    ivec4 region = {{0,0,width,height}};
     size_t i;
 
     assert( self );
@@ -215,29 +642,31 @@ texture_atlas_get_region( texture_atlas_t * self,
     best_width = INT_MAX;
 	for( i=0; i<self->nodes->size; ++i )
 	{
-        y = texture_atlas_fit( self, i, width, height );
+        // A region can't be placed lower than the node it starts on, and
+        // fitting stops as soon as it gets worse than the best one so far.
+        node = (ivec3 *) self->nodes->items + i;
+        if( (node->y + (int) height) > best_height )
+        {
+            continue;
+        }
+        y = texture_atlas_fit( self, i, width, height, best_height );
 		if( y >= 0 )
 		{
-            node = (ivec3 *) vector_get( self->nodes, i );
 			if( ( (y + height) < best_height ) ||
                 ( ((y + height) == best_height) && (node->z < best_width)) )
 			{
 				best_height = y + height;
 				best_index = i;
 				best_width = node->z;
-				region.x = node->x;
-				region.y = y;
+				region->x = node->x;
+				region->y = y;
 			}
         }
     }
    
 	if( best_index == -1 )
     {
-        region.x = -1;
-        region.y = -1;
-        region.width = 0;
-        region.height = 0;
-        return region;
+        return 0;
     }
 
     node = (ivec3 *) malloc( sizeof(ivec3) );
@@ -247,8 +676,8 @@ texture_atlas_get_region( texture_atlas_t * self,
                  "line %d: No more memory for allocating data\n", __LINE__ );
         exit( EXIT_FAILURE );
     }
-    node->x = region.x;
-    node->y = region.y + height;
+    node->x = region->x;
+    node->y = region->y + height;
     node->z = width;
     vector_insert( self->nodes, best_index, node );
     free( node );
@@ -258,6 +687,11 @@ texture_atlas_get_region( texture_atlas_t * self,
         node = (ivec3 *) vector_get( self->nodes, i );
         prev = (ivec3 *) vector_get( self->nodes, i-1 );
 
+        // First node of next page
+        if( (node->y / self->height) != (prev->y / self->height) )
+        {
+            break;
+        }
         if (node->x < (prev->x + prev->z) )
         {
             int shrink = prev->x + prev->z - node->x;
@@ -278,29 +712,518 @@ texture_atlas_get_region( texture_atlas_t * self,
             break;
         }
     }
-    texture_atlas_merge( self );
+
+    // Only the new node may be level with its neighbours
+    node = (ivec3 *) vector_get( self->nodes, best_index );
+    if( best_index+1 < (int) vector_size( self->nodes ) )
+    {
+        ivec3 *next = (ivec3 *) vector_get( self->nodes, best_index+1 );
+        if( next->y == node->y )
+        {
+            node->z += next->z;
+            vector_erase( self->nodes, best_index+1 );
+        }
+    }
+    if( best_index > 0 )
+    {
+        prev = (ivec3 *) vector_get( self->nodes, best_index-1 );
+        if( prev->y == node->y )
+        {
+            prev->z += node->z;
+            vector_erase( self->nodes, best_index );
+        }
+    }
+    return 1;
+}
+
+
+
+
+// ----------------------------------------------- texture_atlas_get_region ---
+ivec4
+texture_atlas_get_region( texture_atlas_t * self,
+                          const size_t width,
+                          const size_t height )
+{
+    ivec4 region = {{0,0,width,height}};
+    int found;
+
+    assert( self );
+
+    // Freed regions are reused first whatever the packer
+    if( texture_atlas_guillotine_region( self->freed, &region ) )
+    {
+        self->used += width * height;
+        return region;
+    }
+
+    switch( self->packer )
+    {
+    case TEXTURE_ATLAS_MAXRECTS:
+        found = texture_atlas_maxrects_region( self, &region );
+        break;
+    case TEXTURE_ATLAS_GUILLOTINE:
+        found = texture_atlas_guillotine_region( self->nodes, &region );
+        break;
+    case TEXTURE_ATLAS_SHELF:
+        found = texture_atlas_shelf_region( self, &region );
+        break;
+    default:
+        found = texture_atlas_skyline_region( self, &region );
+        break;
+    }
+
+    if( !found )
+    {
+        if( texture_atlas_add_page( self ) || texture_atlas_grow( self ) )
+        {
+            return texture_atlas_get_region( self, width, height );
+        }
+        region.x = -1;
+        region.y = -1;
+        region.width = 0;
+        region.height = 0;
+        return region;
+    }
     self->used += width * height;
     return region;
 }
 
 
+// ---------------------------------------------- texture_atlas_free_region ---
+void
+texture_atlas_free_region( texture_atlas_t * self,
+                           const ivec4 region )
+{
+    size_t i;
+
+    assert( self );
+    assert( region.x > 0 );
+    assert( (region.x + region.width) <= (int)(self->width-1) );
+    assert( (region.y % self->height) > 0 );
+    assert( ((region.y % self->height) + region.height) <= (self->height-1) );
+
+    // Regions rely on unused pixels being black (glyph separation)
+    texture_atlas_own_data( self );
+    for( i=0; i<(size_t)region.height; ++i )
+    {
+        memset( self->data + ((region.y+i)*self->width + region.x)*self->depth,
+                0, region.width*self->depth );
+    }
+    vector_push_back( self->dirty, &region );
+    vector_push_back( self->freed, &region );
+    self->used -= region.width * region.height;
+}
+
+
+// --------------------------------------------- texture_atlas_repack_compare ---
+int
+texture_atlas_repack_compare( const void * a,
+                              const void * b )
+{
+    const ivec4 *r1 = *(const ivec4 **) a;
+    const ivec4 *r2 = *(const ivec4 **) b;
+
+    if( r1->height != r2->height )
+    {
+        return r2->height - r1->height;
+    }
+    return r2->width - r1->width;
+}
+
+
+// --------------------------------------------------- texture_atlas_repack ---
+int
+texture_atlas_repack( texture_atlas_t * self,
+                      const ivec4 * regions,
+                      ivec4 * result,
+                      const size_t count )
+{
+    texture_atlas_t *packed;
+    const ivec4 **order;
+    vector_t *swap;
+    size_t i, j, k;
+
+    assert( self );
+    assert( self->data );
+
+    texture_atlas_own_data( self );
+    order = (const ivec4 **) malloc( count * sizeof(ivec4 *) );
+    if( (order == NULL) && count )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    for( i=0; i<count; ++i )
+    {
+        order[i] = regions + i;
+    }
+    qsort( order, count, sizeof(ivec4 *), texture_atlas_repack_compare );
+
+    // Pack into a scratch atlas of same size such that nothing is changed
+    // if regions do not fit.
+    packed = texture_atlas_new_with_packer( self->width, self->height,
+                                            self->depth, self->packer );
+    packed->max_width = self->width;
+    packed->max_height = self->height;
+    packed->max_pages = self->page_count;
+    for( i=0; i<count; ++i )
+    {
+        k = order[i] - regions;
+        result[k] = texture_atlas_get_region( packed, regions[k].width,
+                                              regions[k].height );
+        if( result[k].x < 0 )
+        {
+            free( order );
+            texture_atlas_delete( packed );
+            return 0;
+        }
+    }
+    free( order );
+    while( packed->page_count < self->page_count )
+    {
+        texture_atlas_add_page( packed );
+    }
+
+    for( k=0; k<count; ++k )
+    {
+        for( j=0; j<(size_t)regions[k].height; ++j )
+        {
+            memcpy( packed->data + ((result[k].y+j)*self->width + result[k].x)*self->depth,
+                    self->data + ((regions[k].y+j)*self->width + regions[k].x)*self->depth,
+                    regions[k].width*self->depth );
+        }
+    }
+
+    // Take packed state and data, old ones go away with the scratch atlas
+    swap = self->nodes;
+    self->nodes = packed->nodes;
+    packed->nodes = swap;
+    swap = self->freed;
+    self->freed = packed->freed;
+    packed->freed = swap;
+    free( self->data );
+    self->data = packed->data;
+    packed->data = NULL;
+    self->used = packed->used;
+    texture_atlas_delete( packed );
+
+    {
+        ivec4 region = {{0, 0, self->width, self->page_count*self->height}};
+        vector_clear( self->dirty );
+        vector_push_back( self->dirty, &region );
+    }
+    return 1;
+}
+
+
+// ------------------------------------------ texture_atlas_enlarge_skyline ---
+void
+texture_atlas_enlarge_skyline( texture_atlas_t * self,
+                               const size_t width,
+                               const size_t height )
+{
+    size_t i, page;
+    size_t old_width = self->width, old_height = self->height;
+    vector_t *nodes;
+
+    // Move nodes to their new page offset. Former right border becomes
+    // usable, new right border is kept free. Nothing to do for height since
+    // nodes have no upper bound.
+    nodes = vector_new( sizeof(ivec3) );
+    for( i=0; i<vector_size( self->nodes ); ++i )
+    {
+        ivec3 node = *(ivec3 *) vector_get( self->nodes, i );
+        page = node.y / old_height;
+        node.y += page*(height - old_height);
+        vector_push_back( nodes, &node );
+        if( (width > old_width) &&
+            ((i+1 == vector_size( self->nodes )) ||
+             (((ivec3 *) vector_get( self->nodes, i+1 ))->y / old_height != page)) )
+        {
+            ivec3 border = {{old_width-1, page*height + 1, width-old_width}};
+            vector_push_back( nodes, &border );
+        }
+    }
+    vector_delete( self->nodes );
+    self->nodes = nodes;
+    texture_atlas_merge( self );
+}
+
+
+// -------------------------------------------- texture_atlas_enlarge_rects ---
+void
+texture_atlas_enlarge_rects( texture_atlas_t * self,
+                             const size_t width,
+                             const size_t height )
+{
+    size_t i, page;
+    int old_width = self->width, old_height = self->height;
+
+    // Shelves only need to move to their new page offset, they are bounded
+    // by the current atlas size.
+    if( self->packer == TEXTURE_ATLAS_SHELF )
+    {
+        for( i=0; i<vector_size( self->nodes ); ++i )
+        {
+            ivec3 *shelf = (ivec3 *) vector_get( self->nodes, i );
+            shelf->y += (shelf->y / old_height)*(height - old_height);
+        }
+        return;
+    }
+
+    for( i=0; i<vector_size( self->nodes ); ++i )
+    {
+        ivec4 *rect = (ivec4 *) vector_get( self->nodes, i );
+        page = rect->y / old_height;
+        // MaxRects free rectangles may overlap, keep them maximal
+        if( self->packer == TEXTURE_ATLAS_MAXRECTS )
+        {
+            if( rect->x + rect->width == old_width-1 )
+            {
+                rect->width += width - old_width;
+            }
+            if( (rect->y % old_height) + rect->height == old_height-1 )
+            {
+                rect->height += height - old_height;
+            }
+        }
+        rect->y += page*(height - old_height);
+    }
+
+    // Former borders become usable, guillotine rectangles must not overlap
+    for( page=0; page<self->page_count; ++page )
+    {
+        if( (int)width > old_width )
+        {
+            ivec4 right = {{old_width-1, page*height + 1,
+                            width-old_width, height-2}};
+            vector_push_back( self->nodes, &right );
+        }
+        if( (int)height > old_height )
+        {
+            ivec4 bottom = {{1, page*height + old_height-1,
+                             old_width-2, height-old_height}};
+            if( self->packer == TEXTURE_ATLAS_MAXRECTS )
+            {
+                bottom.width = width-2;
+            }
+            vector_push_back( self->nodes, &bottom );
+        }
+    }
+    if( self->packer == TEXTURE_ATLAS_MAXRECTS )
+    {
+        texture_atlas_maxrects_prune( self->nodes, 0 );
+    }
+}
+
+
+// -------------------------------------------------- texture_atlas_enlarge ---
+void
+texture_atlas_enlarge( texture_atlas_t * self,
+                       const size_t width,
+                       const size_t height )
+{
+    size_t i, page, old_width, old_height;
+    unsigned char *data;
+
+    assert( self );
+    assert( self->data );
+    assert( width >= self->width );
+    assert( height >= self->height );
+
+    old_width = self->width;
+    old_height = self->height;
+    if( (width == old_width) && (height == old_height) )
+    {
+        return;
+    }
+    texture_atlas_own_data( self );
+
+    data = (unsigned char *) calloc( self->page_count*width*height*self->depth,
+                                     sizeof(unsigned char) );
+    if( data == NULL)
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    for( page=0; page<self->page_count; ++page )
+    {
+        for( i=0; i<old_height; ++i )
+        {
+            memcpy( data + ((page*height + i)*width)*self->depth,
+                    self->data + ((page*old_height + i)*old_width)*self->depth,
+                    old_width*self->depth );
+        }
+    }
+    free( self->data );
+    self->data = data;
+
+    if( self->packer == TEXTURE_ATLAS_SKYLINE )
+    {
+        texture_atlas_enlarge_skyline( self, width, height );
+    }
+    else
+    {
+        texture_atlas_enlarge_rects( self, width, height );
+    }
+    for( i=0; i<vector_size( self->freed ); ++i )
+    {
+        ivec4 *region = (ivec4 *) vector_get( self->freed, i );
+        region->y += (region->y / old_height)*(height - old_height);
+    }
+    self->width = width;
+    self->height = height;
+
+    // Texture needs to be reallocated
+    {
+        ivec4 region = {{0, 0, width, self->page_count*height}};
+        vector_clear( self->dirty );
+        vector_push_back( self->dirty, &region );
+    }
+
+    for( i=0; i<vector_size( self->listeners ); ++i )
+    {
+        texture_atlas_listener_t *listener =
+            (texture_atlas_listener_t *) vector_get( self->listeners, i );
+        listener->func( listener->data, old_width, old_height, width, height );
+    }
+}
+
+
+// --------------------------------------------- texture_atlas_add_listener ---
+void
+texture_atlas_add_listener( texture_atlas_t * self,
+                            texture_atlas_resize_func_t func,
+                            void * data )
+{
+    texture_atlas_listener_t listener;
+
+    assert( self );
+    assert( func );
+
+    listener.func = func;
+    listener.data = data;
+    vector_push_back( self->listeners, &listener );
+}
+
+
+// ------------------------------------------ texture_atlas_remove_listener ---
+void
+texture_atlas_remove_listener( texture_atlas_t * self,
+                               texture_atlas_resize_func_t func,
+                               void * data )
+{
+    size_t i;
+
+    assert( self );
+
+    for( i=0; i<vector_size( self->listeners ); ++i )
+    {
+        texture_atlas_listener_t *listener =
+            (texture_atlas_listener_t *) vector_get( self->listeners, i );
+        if( (listener->func == func) && (listener->data == data) )
+        {
+            vector_erase( self->listeners, i );
+            return;
+        }
+    }
+}
+
+
 // ---------------------------------------------------- texture_atlas_clear ---
 void
 texture_atlas_clear( texture_atlas_t * self )
 {
-    ivec3 node = {{1,1,1}};
+    size_t i;
 
     assert( self );
     assert( self->data );
 
     vector_clear( self->nodes );
+    vector_clear( self->freed );
     self->used = 0;
-    // We want a one pixel border around the whole atlas to avoid any artefact when
-    // sampling texture
-    node.z = self->width-2;
+    for( i=0; i<self->page_count; ++i )
+    {
+        texture_atlas_init_page( self, i );
+    }
+    texture_atlas_own_data( self );
+    memset( self->data, 0, self->page_count*self->width*self->height*self->depth );
 
-    vector_push_back( self->nodes, &node );
-    memset( self->data, 0, self->width*self->height*self->depth );
+    {
+        ivec4 region = {{0, 0, self->width, self->page_count*self->height}};
+        vector_clear( self->dirty );
+        vector_push_back( self->dirty, &region );
+    }
+}
+
+
+// ---------------------------------------------- texture_atlas_merge_dirty ---
+void
+texture_atlas_merge_dirty( texture_atlas_t * self )
+{
+    size_t i, j;
+    ivec4 *a, *b;
+    int x0, y0, x1, y1, waste;
+
+    assert( self );
+
+    for( i=0; i<vector_size( self->dirty ); ++i )
+    {
+        for( j=i+1; j<vector_size( self->dirty ); ++j )
+        {
+            a = (ivec4 *) vector_get( self->dirty, i );
+            b = (ivec4 *) vector_get( self->dirty, j );
+            if( (a->y / self->height) != (b->y / self->height) )
+            {
+                continue;
+            }
+            x0 = a->x < b->x ? a->x : b->x;
+            y0 = a->y < b->y ? a->y : b->y;
+            x1 = (a->x + a->width) > (b->x + b->width) ?
+                 (a->x + a->width) : (b->x + b->width);
+            y1 = (a->y + a->height) > (b->y + b->height) ?
+                 (a->y + a->height) : (b->y + b->height);
+            waste = (x1-x0)*(y1-y0) - a->width*a->height - b->width*b->height;
+            if( waste <= UPLOAD_OVERHEAD )
+            {
+                a->x = x0;
+                a->y = y0;
+                a->width = x1-x0;
+                a->height = y1-y0;
+                vector_erase( self->dirty, j );
+                // Merged region may now be close to previous ones
+                j = i;
+            }
+        }
+    }
+}
+
+
+// -------------------------------------------- texture_atlas_upload_region ---
+void
+texture_atlas_upload_region( texture_atlas_t * self,
+                             GLenum target,
+                             const ivec4 * region,
+                             GLenum format,
+                             GLenum type,
+                             const unsigned char * data )
+{
+    size_t page = region->y / self->height;
+    size_t y = region->y - page*self->height;
+
+#ifdef GL_TEXTURE_2D_ARRAY
+    if( target == GL_TEXTURE_2D_ARRAY )
+    {
+        glTexSubImage3D( target, 0, region->x, y, page,
+                         region->width, region->height, 1, format, type, data );
+        return;
+    }
+#endif
+    glTexSubImage2D( target, 0, region->x, y,
+                     region->width, region->height, format, type, data );
 }
 
 
@@ -308,38 +1231,142 @@ texture_atlas_clear( texture_atlas_t * self )
 void
 texture_atlas_upload( texture_atlas_t * self )
 {
+    size_t i, area, size;
+    GLenum target, format, type;
+    GLint internal_format;
+    GLint alignment;
+
     assert( self );
     assert( self->data );
 
-    if( !self->id )
+    if( !self->upload )
     {
-        glGenTextures( 1, &self->id );
+        return;
     }
 
-    glBindTexture( GL_TEXTURE_2D, self->id );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
-    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+#ifdef GL_TEXTURE_2D_ARRAY
+    target = self->max_pages > 1 ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+#else
+    assert( self->max_pages == 1 );
+    target = GL_TEXTURE_2D;
+#endif
+    size = self->page_count*self->width*self->height;
+
     if( self->depth == 4 )
     {
+        internal_format = GL_RGBA;
 #ifdef GL_UNSIGNED_INT_8_8_8_8_REV
-        glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, self->width, self->height,
-                      0, GL_BGRA, GL_UNSIGNED_INT_8_8_8_8_REV, self->data );
+        format = GL_BGRA;
+        type = GL_UNSIGNED_INT_8_8_8_8_REV;
 #else
-        glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA, self->width, self->height,
-                      0, GL_RGBA, GL_UNSIGNED_BYTE, self->data );
+        format = GL_RGBA;
+        type = GL_UNSIGNED_BYTE;
 #endif
     }
     else if( self->depth == 3 )
     {
-        glTexImage2D( GL_TEXTURE_2D, 0, GL_RGB, self->width, self->height,
-                      0, GL_RGB, GL_UNSIGNED_BYTE, self->data );
+        internal_format = GL_RGB;
+        format = GL_RGB;
+        type = GL_UNSIGNED_BYTE;
     }
     else
     {
-        glTexImage2D( GL_TEXTURE_2D, 0, GL_ALPHA, self->width, self->height,
-                      0, GL_ALPHA, GL_UNSIGNED_BYTE, self->data );
+        internal_format = GL_ALPHA;
+        format = GL_ALPHA;
+        type = GL_UNSIGNED_BYTE;
     }
-}
 
+    if( !self->id )
+    {
+        glGenTextures( 1, &self->id );
+        glBindTexture( target, self->id );
+        glTexParameteri( target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+        glTexParameteri( target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+        glTexParameteri( target, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+        glTexParameteri( target, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+        vector_clear( self->dirty );
+    }
+    else
+    {
+        if( vector_empty( self->dirty ) )
+        {
+            return;
+        }
+        glBindTexture( target, self->id );
+
+        // Don't bother merging regions if a full upload is cheaper anyway
+        area = 0;
+        for( i=0; i<vector_size( self->dirty ); ++i )
+        {
+            ivec4 *region = (ivec4 *) vector_get( self->dirty, i );
+            area += region->width*region->height + UPLOAD_OVERHEAD;
+        }
+        if( area < size )
+        {
+            texture_atlas_merge_dirty( self );
+            area = 0;
+            for( i=0; i<vector_size( self->dirty ); ++i )
+            {
+                ivec4 *region = (ivec4 *) vector_get( self->dirty, i );
+                area += region->width*region->height + UPLOAD_OVERHEAD;
+            }
+        }
+        if( area >= size )
+        {
+            vector_clear( self->dirty );
+        }
+    }
+
+    if( vector_empty( self->dirty ) )
+    {
+#ifdef GL_TEXTURE_2D_ARRAY
+        if( target == GL_TEXTURE_2D_ARRAY )
+        {
+            glTexImage3D( target, 0, internal_format, self->width, self->height,
+                          self->page_count, 0, format, type, self->data );
+        }
+        else
+#endif
+        {
+            glTexImage2D( target, 0, internal_format, self->width, self->height,
+                          0, format, type, self->data );
+        }
+        self->upload_count++;
+        self->upload_bytes += size*self->depth;
+        return;
+    }
+
+    glGetIntegerv( GL_UNPACK_ALIGNMENT, &alignment );
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+#ifdef GL_UNPACK_ROW_LENGTH
+    glPixelStorei( GL_UNPACK_ROW_LENGTH, self->width );
+#endif
+    for( i=0; i<vector_size( self->dirty ); ++i )
+    {
+        ivec4 *region = (ivec4 *) vector_get( self->dirty, i );
+        size_t bytes = region->width*region->height*self->depth;
+#ifdef GL_UNPACK_ROW_LENGTH
+        texture_atlas_upload_region( self, target, region, format, type,
+            self->data + (region->y*self->width + region->x)*self->depth );
+#else
+        // No GL_UNPACK_ROW_LENGTH (OpenGL ES 2.0), region must be packed
+        size_t j, line = region->width*self->depth;
+        unsigned char *data = (unsigned char *) malloc( bytes );
+        for( j=0; j<region->height; ++j )
+        {
+            memcpy( data + j*line,
+                    self->data + ((region->y+j)*self->width + region->x)*self->depth,
+                    line );
+        }
+        texture_atlas_upload_region( self, target, region, format, type, data );
+        free( data );
+#endif
+        self->upload_count++;
+        self->upload_bytes += bytes;
+    }
+#ifdef GL_UNPACK_ROW_LENGTH
+    glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+#endif
+    glPixelStorei( GL_UNPACK_ALIGNMENT, alignment );
+    vector_clear( self->dirty );
+}
@@ -92,13 +92,66 @@ extern "C" {
  */
 
 
+/**
+ * Function called when an atlas has been resized.
+ *
+ * @param data       user data given when the listener was added
+ * @param old_width  previous width of the atlas
+ * @param old_height previous height of the atlas
+ * @param width      new width of the atlas
+ * @param height     new height of the atlas
+ */
+typedef void (*texture_atlas_resize_func_t)( void * data,
+                                             const size_t old_width,
+                                             const size_t old_height,
+                                             const size_t width,
+                                             const size_t height );
+
+
+/**
+ * Listener notified when an atlas is resized.
+ */
+typedef struct
+{
+    /**
+     * Function to be called
+     */
+    texture_atlas_resize_func_t func;
+
+    /**
+     * User data
+     */
+    void * data;
+} texture_atlas_listener_t;
+
+
+/**
+ * Packing strategies (see texture_atlas_new_with_packer)
+ */
+/** Skyline bottom-left (default), fast with good occupancy */
+#define TEXTURE_ATLAS_SKYLINE    0
+/** MaxRects best short side fit, best occupancy but slowest */
+#define TEXTURE_ATLAS_MAXRECTS   1
+/** Guillotine best area fit, split along the longest leftover side */
+#define TEXTURE_ATLAS_GUILLOTINE 2
+/** Shelves (rows) best height fit, cheapest, suited to regions of
+ *  (nearly) same height such as monospace console glyphs */
+#define TEXTURE_ATLAS_SHELF      3
+
+
 /**
  * A texture atlas is used to pack several small regions into a single texture.
  */
 typedef struct
 {
     /**
-     * Allocated nodes
+     * Packing strategy
+     */
+    int packer;
+
+    /**
+     * Allocated nodes: skyline (ivec3 x, y, width), shelves (ivec3 x, y,
+     * height) or free rectangles (ivec4) for MaxRects and guillotine
      */
     vector_t * nodes;
 
@@ -117,21 +170,94 @@ typedef struct
      */
     size_t depth;
 
+    /**
+     * Maximum width (in pixels) the atlas can grow to when full
+     */
+    size_t max_width;
+
+    /**
+     * Maximum height (in pixels) the atlas can grow to when full
+     */
+    size_t max_height;
+
+    /**
+     * Number of pages (texture array layers) in use
+     */
+    size_t page_count;
+
+    /**
+     * Maximum number of pages. When greater than 1, the atlas is uploaded as
+     * a 2D texture array (GL_TEXTURE_2D_ARRAY) and a new page is opened
+     * whenever a region does not fit in existing pages.
+     */
+    size_t max_pages;
+
+    /**
+     * Listeners (texture_atlas_listener_t) notified when atlas is resized
+     */
+    vector_t * listeners;
+
     /**
      * Allocated surface size
      */
     size_t used;
 
+    /**
+     * Freed regions (ivec4) to be reused before allocating from the skyline
+     */
+    vector_t * freed;
+
+    /**
+     * Use counter that users of the atlas may increment to know which
+     * regions were least recently used (see texture_font_get_glyph).
+     */
+    size_t clock;
+
     /**
      * Texture identity (OpenGL)
      */
     unsigned int id;
 
     /**
-     * Atlas data
+     * Atlas data (pages stored one after the other)
      */
     unsigned char * data;
 
+    /**
+     * Read-only file mapping data points into when the atlas comes from a
+     * font cache (NULL when data is allocated). Data is copied before the
+     * atlas is first modified.
+     */
+    void * mapping;
+
+    /**
+     * Size of the file mapping
+     */
+    size_t mapping_size;
+
+    /**
+     * Whether texture_atlas_upload sends data to OpenGL. Atlases filled
+     * without any OpenGL context (e.g. by makefont) set it to 0.
+     */
+    int upload;
+
+    /**
+     * Regions (ivec4) modified since last upload
+     */
+    vector_t * dirty;
+
+    /**
+     * Number of texture upload calls (glTexImage2D or glTexSubImage2D) made
+     * so far. May be reset by the application (e.g. at each frame).
+     */
+    size_t upload_count;
+
+    /**
+     * Number of bytes uploaded so far. May be reset by the application
+     * (e.g. at each frame).
+     */
+    size_t upload_bytes;
+
 } texture_atlas_t;
 
 
@@ -151,6 +277,24 @@ typedef struct
                      const size_t depth );
 
 
+/**
+ * Creates a new empty texture atlas using a specific packing strategy.
+ *
+ * @param   width   width of the atlas
+ * @param   height  height of the atlas
+ * @param   depth   bit depth of the atlas
+ * @param   packer  TEXTURE_ATLAS_SKYLINE, TEXTURE_ATLAS_MAXRECTS,
+ *                  TEXTURE_ATLAS_GUILLOTINE or TEXTURE_ATLAS_SHELF
+ * @return          a new empty texture atlas.
+ *
+ */
+  texture_atlas_t *
+  texture_atlas_new_with_packer( const size_t width,
+                                 const size_t height,
+                                 const size_t depth,
+                                 const int packer );
+
+
 /**
  *  Deletes a texture atlas.
  *
@@ -162,7 +306,9 @@ typedef struct
 
 
 /**
- *  Upload atlas to video memory.
+ *  Upload atlas to video memory. Only the regions modified since the last
+ *  upload are sent (merged together when close enough), unless uploading
+ *  the whole atlas is cheaper.
  *
  *  @param self a texture atlas structure
  *
@@ -172,12 +318,15 @@ typedef struct
 
 
 /**
- *  Allocate a new region in the atlas.
+ *  Allocate a new region in the atlas. Pages are tried in order. If there is
+ *  no room left, a new page is opened (up to max_pages) or the atlas is
+ *  enlarged (up to max_width x max_height) and listeners are notified.
  *
  *  @param self   a texture atlas structure
  *  @param width  width of the region to allocate
  *  @param height height of the region to allocate
- *  @return       Coordinates of the allocated region
+ *  @return       Coordinates of the allocated region. Pages being stored one
+ *                after the other, page index is y / height.
  *
  */
   ivec4
@@ -186,6 +335,39 @@ typedef struct
                             const size_t height );
 
 
+/**
+ *  Free a region previously allocated with texture_atlas_get_region. Region
+ *  is cleared and will be reused for new regions.
+ *
+ *  @param self   a texture atlas structure
+ *  @param region region to be freed
+ *
+ */
+  void
+  texture_atlas_free_region( texture_atlas_t * self,
+                             const ivec4 region );
+
+
+/**
+ *  Move regions such that they are packed again from scratch (largest
+ *  first), discarding fragmentation left by freed regions. Regions that are
+ *  not given are lost. Atlas is left untouched if regions do not fit in the
+ *  current atlas size and number of pages.
+ *
+ *  @param self    a texture atlas structure
+ *  @param regions regions to be kept
+ *  @param result  new location of each region
+ *  @param count   number of regions
+ *  @return        1 if regions have been moved, 0 otherwise
+ *
+ */
+  int
+  texture_atlas_repack( texture_atlas_t * self,
+                        const ivec4 * regions,
+                        ivec4 * result,
+                        const size_t count );
+
+
 /**
  *  Upload data to the specified atlas region.
  *
@@ -207,6 +389,47 @@ typedef struct
                             const unsigned char *data,
                             const size_t stride );
 
+/**
+ *  Enlarge the atlas, keeping existing regions at the same place (in pixels).
+ *  Texture coordinates computed from the previous size must be rescaled by
+ *  listeners.
+ *
+ *  @param self   a texture atlas structure
+ *  @param width  new width (greater or equal to current width)
+ *  @param height new height (greater or equal to current height)
+ */
+  void
+  texture_atlas_enlarge( texture_atlas_t * self,
+                         const size_t width,
+                         const size_t height );
+
+
+/**
+ *  Add a listener to be notified when the atlas is resized.
+ *
+ *  @param self   a texture atlas structure
+ *  @param func   function to be called
+ *  @param data   user data given to the function
+ */
+  void
+  texture_atlas_add_listener( texture_atlas_t * self,
+                              texture_atlas_resize_func_t func,
+                              void * data );
+
+
+/**
+ *  Remove a listener previously added.
+ *
+ *  @param self   a texture atlas structure
+ *  @param func   function given when the listener was added
+ *  @param data   user data given when the listener was added
+ */
+  void
+  texture_atlas_remove_listener( texture_atlas_t * self,
+                                 texture_atlas_resize_func_t func,
+                                 void * data );
+
+
 /**
  *  Remove all allocated regions from the atlas.
  *
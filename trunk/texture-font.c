@@ -34,8 +34,12 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 #include FT_STROKER_H
-// #include FT_ADVANCES_H
 #include FT_LCD_FILTER_H
+#include FT_TRUETYPE_TABLES_H
+#include FT_TRUETYPE_TAGS_H
+#include FT_ADVANCES_H
+#include FT_SIZES_H
+#include FT_OUTLINE_H
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -43,8 +47,13 @@
 #include <math.h>
 #include <wchar.h>
 #include "platform.h"
+#include "distance-field.h"
 #include "texture-font.h"
 
+// Outline thickness is quantized to the stroker resolution (26.6 fixed point)
+// when used as a glyph cache key
+#define THICKNESS_KEY(thickness) ((int)((thickness)*64))
+
 #undef __FTERRORS_H__
 #define FT_ERRORDEF( e, v, s )  { e, s },
 #define FT_ERROR_START_LIST     {
@@ -58,12 +67,10 @@ const struct {
 
 
 
-// ------------------------------------------------- texture_font_load_face ---
-int
-texture_font_load_face( FT_Library * library,
-                        const char * filename,
-                        const float size,
-                        FT_Face * face )
+// -------------------------------------------------- texture_font_set_size ---
+FT_Error
+texture_font_set_size( FT_Face face,
+                       const float size )
 {
     size_t hres = 64;
     FT_Error error;
@@ -72,26 +79,43 @@ texture_font_load_face( FT_Library * library,
                          (int)((0.0)      * 0x10000L),
                          (int)((1.0)      * 0x10000L) };
 
-    assert( library );
-    assert( filename );
+    assert( face );
     assert( size );
 
-    /* Initialize library */
-    error = FT_Init_FreeType( library );
+    /* Set char size */
+    error = FT_Set_Char_Size( face, (int)(size*64), 0, 72*hres, 72 );
     if( error )
     {
-        fprintf(stderr, "FT_Error (0x%02x) : %s\n",
-                FT_Errors[error].code, FT_Errors[error].message);
-        return 0;
+        return error;
     }
 
-    /* Load face */
-    error = FT_New_Face( *library, filename, 0, face );
+    /* Set transform matrix */
+    FT_Set_Transform( face, &matrix, NULL );
+
+    return 0;
+}
+
+
+// ------------------------------------------------- texture_font_load_face ---
+int
+texture_font_load_face( FT_Library library,
+                        const font_file_t * file,
+                        const float size,
+                        FT_Face * face )
+{
+    FT_Error error;
+
+    assert( library );
+    assert( file );
+    assert( size );
+
+    /* Load face (file content is owned by the font registry) */
+    error = FT_New_Memory_Face( library, file->data, (FT_Long) file->size,
+                                0, face );
     if( error )
     {
         fprintf( stderr, "FT_Error (line %d, code 0x%02x) : %s\n",
                  __LINE__, FT_Errors[error].code, FT_Errors[error].message);
-        FT_Done_FreeType( *library );
         return 0;
     }
 
@@ -102,24 +126,19 @@ texture_font_load_face( FT_Library * library,
         fprintf( stderr, "FT_Error (line %d, code 0x%02x) : %s\n",
                  __LINE__, FT_Errors[error].code, FT_Errors[error].message );
         FT_Done_Face( *face );
-        FT_Done_FreeType( *library );
         return 0;
     }
 
     /* Set char size */
-    error = FT_Set_Char_Size( *face, (int)(size*64), 0, 72*hres, 72 );
+    error = texture_font_set_size( *face, size );
     if( error )
     {
         fprintf( stderr, "FT_Error (line %d, code 0x%02x) : %s\n",
                  __LINE__, FT_Errors[error].code, FT_Errors[error].message );
         FT_Done_Face( *face );
-        FT_Done_FreeType( *library );
         return 0;
     }
 
-    /* Set transform matrix */
-    FT_Set_Transform( *face, &matrix, NULL );
-
     return 1;
 }
 
@@ -136,10 +155,12 @@ texture_glyph_new( void )
         exit( EXIT_FAILURE );
     }
     self->id        = 0;
+    self->glyph_index = 0;
     self->width     = 0;
     self->height    = 0;
     self->outline_type = 0;
     self->outline_thickness = 0.0;
+    self->phase     = 0;
     self->offset_x  = 0;
     self->offset_y  = 0;
     self->advance_x = 0.0;
@@ -148,7 +169,10 @@ texture_glyph_new( void )
     self->t0        = 0.0;
     self->s1        = 0.0;
     self->t1        = 0.0;
-    self->kerning   = vector_new( sizeof(kerning_t) );
+    self->page      = 0;
+    self->last_used = 0;
+    self->pending   = 0;
+    self->kerning_table = NULL;
     return self;
 }
 
@@ -158,444 +182,2157 @@ void
 texture_glyph_delete( texture_glyph_t *self )
 {
     assert( self );
-    vector_delete( self->kerning );
     free( self );
 }
 
-// ---------------------------------------------- texture_glyph_get_kerning ---
-float 
-texture_glyph_get_kerning( const texture_glyph_t * self,
-                           const wchar_t charcode )
+// ----------------------------------------------------- kerning_table_new ---
+kerning_table_t *
+kerning_table_new( size_t capacity )
 {
-    size_t i;
+    kerning_table_t *self = (kerning_table_t *) malloc( sizeof(kerning_table_t) );
+    if( self == NULL)
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->pairs = (kerning_pair_t *) calloc( capacity, sizeof(kerning_pair_t) );
+    self->filter = (unsigned char *) calloc( capacity, 1 );
+    if( (self->pairs == NULL) || (self->filter == NULL) )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->wide = vector_new( sizeof(kerning_wide_pair_t) );
+    self->capacity = capacity;
+    self->count = 0;
+    self->used = 0;
+    self->lookups = 0;
+    self->probes = 0;
+    self->filtered = 0;
+    return self;
+}
+
 
+// -------------------------------------------------- kerning_table_delete ---
+void
+kerning_table_delete( kerning_table_t * self )
+{
     assert( self );
-    for( i=0; i<vector_size(self->kerning); ++i )
+    vector_delete( self->wide );
+    free( self->filter );
+    free( self->pairs );
+    free( self );
+}
+
+
+// ---------------------------------------------------- kerning_table_hash ---
+uint32_t
+kerning_table_hash( const uint16_t left,
+                    const uint16_t right )
+{
+    uint32_t h = ((uint32_t) left << 16) | right;
+
+    // Murmur3 finalizer
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+
+// ------------------------------------------------- kerning_table_filter ---
+// Whether the filter may hold a pair of hash h (two bits out of capacity*8,
+// the second one from the high half of the hash)
+int
+kerning_table_filter( const kerning_table_t * self,
+                      const uint32_t h )
+{
+    size_t mask = 8*self->capacity - 1;
+    size_t a = h & mask;
+    size_t b = ((h >> 16) | (h << 16)) & mask;
+
+    return ((self->filter[a >> 3] >> (a & 7)) & 1) &&
+           ((self->filter[b >> 3] >> (b & 7)) & 1);
+}
+
+
+// ---------------------------------------------------- kerning_table_slot ---
+kerning_pair_t *
+kerning_table_slot( const kerning_table_t * self,
+                    const uint16_t left,
+                    const uint16_t right )
+{
+    size_t mask = self->capacity - 1;
+    size_t i = kerning_table_hash( left, right ) & mask;
+    kerning_pair_t *pair = &self->pairs[i];
+
+    while( pair->kerning && ((pair->left != left) || (pair->right != right)) )
     {
-        kerning_t * kerning = (kerning_t *) vector_get( self->kerning, i );
-        if( kerning->charcode == charcode )
+        i = (i+1) & mask;
+        pair = &self->pairs[i];
+    }
+    return pair;
+}
+
+
+// -------------------------------------------------- kerning_table_insert ---
+// Store a pair in its slot and in the filter
+void
+kerning_table_insert( kerning_table_t * self,
+                      const kerning_pair_t * pair )
+{
+    uint32_t h = kerning_table_hash( pair->left, pair->right );
+    size_t mask = 8*self->capacity - 1;
+    size_t a = h & mask;
+    size_t b = ((h >> 16) | (h << 16)) & mask;
+
+    *kerning_table_slot( self, pair->left, pair->right ) = *pair;
+    self->filter[a >> 3] |= (unsigned char)( 1 << (a & 7) );
+    self->filter[b >> 3] |= (unsigned char)( 1 << (b & 7) );
+}
+
+
+// ---------------------------------------------------- kerning_table_wide ---
+// Pair kept aside, NULL if there is none
+kerning_wide_pair_t *
+kerning_table_wide( const kerning_table_t * self,
+                    const wchar_t left,
+                    const wchar_t right )
+{
+    size_t i;
+
+    for( i=0; i<vector_size( self->wide ); ++i )
+    {
+        kerning_wide_pair_t *wide =
+            (kerning_wide_pair_t *) vector_get( self->wide, i );
+        if( (wide->left == left) && (wide->right == right) )
         {
-            return kerning->kerning;
+            return wide;
         }
     }
-    return 0;
+    return NULL;
 }
 
 
-// ------------------------------------------ texture_font_generate_kerning ---
+// ----------------------------------------------------- kerning_table_set ---
 void
-texture_font_generate_kerning( texture_font_t *self )
+kerning_table_set( kerning_table_t * self,
+                   const wchar_t left,
+                   const wchar_t right,
+                   const float kerning )
 {
-    size_t i, j;
-    FT_Library library;
-    FT_Face face;
-    FT_UInt glyph_index, prev_index;
-    texture_glyph_t *glyph, *prev_glyph;
-    FT_Vector kerning;
-    
+    kerning_pair_t pair, *slot;
+    kerning_wide_pair_t wide, *other;
+    float value;
+    size_t i;
+
     assert( self );
+    assert( kerning );
 
-    /* Load font */
-    if( !texture_font_load_face( &library, self->filename, self->size, &face ) )
+    wide.left = left;
+    wide.right = right;
+    wide.kerning = kerning;
+    if( ((uint32_t) left > 0xffff) || ((uint32_t) right > 0xffff) )
     {
+        other = kerning_table_wide( self, left, right );
+        if( other )
+        {
+            other->kerning = kerning;
+            return;
+        }
+        vector_push_back( self->wide, &wide );
+        ++self->count;
         return;
     }
 
-    /* For each glyph couple combination, check if kerning is necessary */
-    /* Starts at index 1 since 0 is for the special backgroudn glyph */
-    for( i=1; i<self->glyphs->size; ++i )
+    pair.left = (uint16_t) left;
+    pair.right = (uint16_t) right;
+    slot = kerning_table_slot( self, pair.left, pair.right );
+    if( slot->kerning == KERNING_WIDE )
     {
-        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
-        glyph_index = FT_Get_Char_Index( face, glyph->charcode );
-        vector_clear( glyph->kerning );
+        kerning_table_wide( self, left, right )->kerning = kerning;
+        return;
+    }
 
-        for( j=1; j<self->glyphs->size; ++j )
+    // Values too large for 16 bits are kept aside, the slot only tells so
+    value = floorf( kerning * KERNING_SCALE + .5f );
+    if( (value > 32767) || (value < -32767) )
+    {
+        vector_push_back( self->wide, &wide );
+        if( slot->kerning )
         {
-            prev_glyph = *(texture_glyph_t **) vector_get( self->glyphs, j );
-            prev_index = FT_Get_Char_Index( face, prev_glyph->charcode );
-            FT_Get_Kerning( face, prev_index, glyph_index, FT_KERNING_UNFITTED, &kerning );
-            // printf("%c(%d)-%c(%d): %ld\n",
-            //       prev_glyph->charcode, prev_glyph->charcode,
-            //       glyph_index, glyph_index, kerning.x);
-            if( kerning.x )
+            slot->kerning = KERNING_WIDE;
+            return;
+        }
+        value = KERNING_WIDE;
+    }
+    // Values too small to be represented are not worth storing
+    else if( !value )
+    {
+        return;
+    }
+    pair.kerning = (int16_t) value;
+    if( slot->kerning )
+    {
+        slot->kerning = pair.kerning;
+        return;
+    }
+
+    // Keep load factor under 3/4
+    if( 4*(self->used + 1) > 3*self->capacity )
+    {
+        kerning_pair_t *pairs = self->pairs;
+        size_t capacity = self->capacity;
+
+        self->capacity *= 2;
+        free( self->filter );
+        self->pairs = (kerning_pair_t *)
+            calloc( self->capacity, sizeof(kerning_pair_t) );
+        self->filter = (unsigned char *) calloc( self->capacity, 1 );
+        if( (self->pairs == NULL) || (self->filter == NULL) )
+        {
+            fprintf( stderr,
+                     "line %d: No more memory for allocating data\n", __LINE__ );
+            exit( EXIT_FAILURE );
+        }
+        for( i=0; i<capacity; ++i )
+        {
+            if( pairs[i].kerning )
             {
-                // 64 * 64 because of 26.6 encoding AND the transform matrix used
-                // in texture_font_load_face (hres = 64)
-                kerning_t k = {prev_glyph->charcode, kerning.x / (float)(64.0f*64.0f)};
-                vector_push_back( glyph->kerning, &k );
+                kerning_table_insert( self, &pairs[i] );
             }
         }
+        free( pairs );
     }
-    FT_Done_Face( face );
-    FT_Done_FreeType( library );
+    kerning_table_insert( self, &pair );
+    ++self->used;
+    ++self->count;
 }
 
 
-// ------------------------------------------------------- texture_font_new ---
-texture_font_t *
-texture_font_new( texture_atlas_t * atlas,
-                  const char * filename,
-                  const float size)
+// ----------------------------------------------------- kerning_table_get ---
+float
+kerning_table_get( kerning_table_t * self,
+                   const wchar_t left,
+                   const wchar_t right )
 {
-    texture_font_t *self = (texture_font_t *) malloc( sizeof(texture_font_t) );
-    FT_Library library;
-    FT_Face face;
-    FT_Size_Metrics metrics;
-    
-    assert( filename );
-    assert( size );
+    size_t mask = self->capacity - 1;
+    kerning_pair_t *pair;
+    kerning_wide_pair_t *wide;
+    uint32_t h;
+    size_t i;
 
-    if( self == NULL)
+    ++self->lookups;
+    if( ((uint32_t) left > 0xffff) || ((uint32_t) right > 0xffff) )
     {
-        fprintf( stderr,
-                 "line %d: No more memory for allocating data\n", __LINE__ );
-        exit( EXIT_FAILURE );
+        ++self->probes;
+        wide = kerning_table_wide( self, left, right );
+        return wide ? wide->kerning : 0;
     }
-    self->glyphs = vector_new( sizeof(texture_glyph_t *) );
-    self->atlas = atlas;
-    self->height = 0;
-    self->ascender = 0;
-    self->descender = 0;
-    self->filename = strdup( filename );
-    self->size = size;
-    self->outline_type = 0;
-    self->outline_thickness = 0.0;
-    self->hinting = 1;
-    self->kerning = 1;
-    self->filtering = 1;
-    // FT_LCD_FILTER_LIGHT   is (0x00, 0x55, 0x56, 0x55, 0x00)
-    // FT_LCD_FILTER_DEFAULT is (0x10, 0x40, 0x70, 0x40, 0x10)
-    self->lcd_weights[0] = 0x10;
-    self->lcd_weights[1] = 0x40;
-    self->lcd_weights[2] = 0x70;
-    self->lcd_weights[3] = 0x40;
-    self->lcd_weights[4] = 0x10;
-
-    /* Get font metrics at high resolution */
 
-    if( !texture_font_load_face( &library, self->filename, self->size*100, &face ) )
+    h = kerning_table_hash( (uint16_t) left, (uint16_t) right );
+    if( !kerning_table_filter( self, h ) )
     {
-        return self;
+        ++self->filtered;
+        return 0;
     }
-
-    // 64 * 64 because of 26.6 encoding AND the transform matrix used
-    // in texture_font_load_face (hres = 64)
-    self->underline_position = face->underline_position / (float)(64.0f*64.0f) * self->size;
-    self->underline_position = round( self->underline_position );
-    if( self->underline_position > -2 )
+    i = h & mask;
+    pair = &self->pairs[i];
+    ++self->probes;
+    while( pair->kerning )
     {
-        self->underline_position = -2.0;
+        if( (pair->left == (uint16_t) left) && (pair->right == (uint16_t) right) )
+        {
+            if( pair->kerning == KERNING_WIDE )
+            {
+                return kerning_table_wide( self, left, right )->kerning;
+            }
+            return pair->kerning / (float) KERNING_SCALE;
+        }
+        i = (i+1) & mask;
+        pair = &self->pairs[i];
+        ++self->probes;
     }
+    return 0;
+}
 
-    self->underline_thickness = face->underline_thickness / (float)(64.0f*64.0f) * self->size;
-    self->underline_thickness = round( self->underline_thickness );
-    if( self->underline_thickness < 1 )
+
+// ---------------------------------------------- texture_glyph_get_kerning ---
+float 
+texture_glyph_get_kerning( const texture_glyph_t * self,
+                           const wchar_t charcode )
+{
+    assert( self );
+
+    if( !self->kerning_table )
     {
-        self->underline_thickness = 1.0;
+        return 0;
     }
+    return kerning_table_get( self->kerning_table, charcode, self->charcode );
+}
 
-    metrics = face->size->metrics; 
-    self->ascender = (metrics.ascender >> 6) / 100.0;
-    self->descender = (metrics.descender >> 6) / 100.0;
-    self->height = (metrics.height >> 6) / 100.0;
-    self->linegap = self->height - self->ascender + self->descender;
-    FT_Done_Face( face );
-    FT_Done_FreeType( library );
 
-    /* -1 is a special glyph */
-    texture_font_get_glyph( self, -1 );
+// ----------------------------------------------- texture_font_get_kerning ---
+float
+texture_font_get_kerning( texture_font_t * self,
+                          const wchar_t left,
+                          const wchar_t right )
+{
+    assert( self );
 
-    return self;
+    return kerning_table_get( self->kerning_table, left, right );
 }
 
 
-// ---------------------------------------------------- texture_font_delete ---
+// ----------------------------------------- texture_font_get_kerning_stats ---
 void
-texture_font_delete( texture_font_t *self )
+texture_font_get_kerning_stats( const texture_font_t * self,
+                                kerning_stats_t * stats )
 {
-    size_t i;
-    texture_glyph_t *glyph;
+    const kerning_table_t * table;
+    const texture_glyph_t * glyph;
+    size_t i, j, count;
 
     assert( self );
-
-    if( self->filename )
+    assert( stats );
+
+    table = self->kerning_table;
+    stats->pairs = table->count;
+    stats->memory = sizeof(kerning_table_t)
+                  + table->capacity * (sizeof(kerning_pair_t) + 1)
+                  + sizeof(vector_t)
+                  + table->wide->capacity * sizeof(kerning_wide_pair_t);
+    stats->lookups = table->lookups;
+    stats->probes = table->lookups ? table->probes / (float) table->lookups : 0;
+    stats->filtered = table->lookups ?
+                      table->filtered / (float) table->lookups : 0;
+
+    // Each glyph had a vector of the pairs it is on the right of, grown
+    // one item at a time
+    stats->vectors_memory = 0;
+    for( i=0; i<vector_size( self->glyphs ); ++i )
     {
-        free( self->filename );
+        glyph = *(const texture_glyph_t **) vector_get( self->glyphs, i );
+        count = 0;
+        for( j=0; j<table->capacity; ++j )
+        {
+            if( table->pairs[j].kerning &&
+                (table->pairs[j].kerning != KERNING_WIDE) &&
+                (table->pairs[j].right == (uint32_t) glyph->charcode) )
+            {
+                ++count;
+            }
+        }
+        for( j=0; j<vector_size( table->wide ); ++j )
+        {
+            if( ((const kerning_wide_pair_t *)
+                 vector_get( table->wide, j ))->right == glyph->charcode )
+            {
+                ++count;
+            }
+        }
+        stats->vectors_memory += sizeof(vector_t)
+            + (count ? count : 1) * (sizeof(wchar_t) + sizeof(float));
     }
+}
 
 
-    for( i=0; i<vector_size( self->glyphs ); ++i)
-    {
-        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
-        texture_glyph_delete( glyph);
-    }
-
-    vector_delete( self->glyphs );
-    free( self );
+// ------------------------------------------------ texture_font_glyph_hash ---
+uint32_t
+texture_font_glyph_hash( const wchar_t charcode,
+                         const int outline_type,
+                         const int thickness,
+                         const int phase )
+{
+    uint32_t h = (uint32_t) charcode;
+
+    h = h*31 + (uint32_t) outline_type;
+    h = h*31 + (uint32_t) thickness;
+    h = h*31 + (uint32_t) phase;
+
+    // Murmur3 finalizer, charcodes are mostly contiguous
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
 }
 
 
-// ----------------------------------------------- texture_font_load_glyphs ---
-size_t
-texture_font_load_glyphs( texture_font_t * self,
-                          const wchar_t * charcodes )
+// ---------------------------------------------- texture_font_index_glyph ---
+void
+texture_font_index_glyph( texture_font_t * self,
+                          texture_glyph_t * glyph )
 {
-    size_t i, x, y, width, height, depth, w, h;
-    FT_Library library;
-    FT_Error error;
-    FT_Face face;
-    FT_Glyph ft_glyph;
-    FT_GlyphSlot slot;
-    FT_Bitmap ft_bitmap;
-
-    FT_UInt glyph_index;
-    texture_glyph_t *glyph;
-    ivec4 region;
-    size_t missed = 0;
+    size_t mask = self->glyph_table_capacity - 1;
+    size_t i = texture_font_glyph_hash( glyph->charcode, glyph->outline_type,
+                                        THICKNESS_KEY(glyph->outline_thickness),
+                                        glyph->phase ) & mask;
 
-    assert( self );
-    assert( charcodes );
+    while( self->glyph_table[i] )
+    {
+        i = (i+1) & mask;
+    }
+    self->glyph_table[i] = glyph;
+}
 
 
-    width  = self->atlas->width;
-    height = self->atlas->height;
-    depth  = self->atlas->depth;
+// ----------------------------------------- texture_font_update_glyph_table ---
+void
+texture_font_update_glyph_table( texture_font_t * self )
+{
+    size_t i, count = vector_size( self->glyphs );
+    texture_glyph_t *glyph;
 
-    if( !texture_font_load_face( &library, self->filename, self->size, &face ) )
+    // Glyphs have been removed, index everything again
+    if( self->glyph_table_count > count )
     {
-        return wcslen(charcodes);
+        memset( self->glyph_table, 0,
+                self->glyph_table_capacity * sizeof(texture_glyph_t *) );
+        self->glyph_table_count = 0;
     }
 
-    /* Load each glyph */
-    for( i=0; i<wcslen(charcodes); ++i )
+    // Keep load factor under 1/2, rebuilding the whole table when it grows
+    if( 2*count > self->glyph_table_capacity )
     {
-        FT_Int32 flags = 0;
-        int ft_bitmap_width = 0;
-        int ft_bitmap_rows = 0;
-        int ft_bitmap_pitch = 0;
-        int ft_glyph_top = 0;
-        int ft_glyph_left = 0;
-        glyph_index = FT_Get_Char_Index( face, charcodes[i] );
-        // WARNING: We use texture-atlas depth to guess if user wants
-        //          LCD subpixel rendering
-
-        if( self->outline_type > 0 )
+        while( 2*count > self->glyph_table_capacity )
         {
-            flags |= FT_LOAD_NO_BITMAP;
+            self->glyph_table_capacity *= 2;
         }
-        else
+        free( self->glyph_table );
+        self->glyph_table = (texture_glyph_t **)
+            calloc( self->glyph_table_capacity, sizeof(texture_glyph_t *) );
+        if( self->glyph_table == NULL)
         {
-            flags |= FT_LOAD_RENDER;
+            fprintf( stderr,
+                     "line %d: No more memory for allocating data\n", __LINE__ );
+            exit( EXIT_FAILURE );
         }
+        self->glyph_table_count = 0;
+    }
 
-        if( !self->hinting )
-        {
-            flags |= FT_LOAD_NO_HINTING | FT_LOAD_NO_AUTOHINT;
-        }
-        else
-        {
-            flags |= FT_LOAD_FORCE_AUTOHINT;
-        }
+    for( i=self->glyph_table_count; i<count; ++i )
+    {
+        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
+        texture_font_index_glyph( self, glyph );
+    }
+    self->glyph_table_count = count;
+}
 
 
-        if( depth == 3 )
-        {
-            FT_Library_SetLcdFilter( library, FT_LCD_FILTER_LIGHT );
-            flags |= FT_LOAD_TARGET_LCD;
-            if( self->filtering )
-            {
-                FT_Library_SetLcdFilterWeights( library, self->lcd_weights );
-            }
-        }
-        error = FT_Load_Glyph( face, glyph_index, flags );
-        if( error )
-        {
-            fprintf( stderr, "FT_Error (line %d, code 0x%02x) : %s\n",
-                     __LINE__, FT_Errors[error].code, FT_Errors[error].message );
-            FT_Done_Face( face );
-            FT_Done_FreeType( library );
-            return wcslen(charcodes)-i;
-        }
+// ----------------------------------------------- texture_font_find_glyph ---
+texture_glyph_t *
+texture_font_find_glyph( texture_font_t * self,
+                         const wchar_t charcode,
+                         const int outline_type,
+                         const float outline_thickness,
+                         const int phase )
+{
+    size_t mask, i;
+    int thickness = THICKNESS_KEY(outline_thickness);
+    texture_glyph_t *glyph;
 
+    if( self->glyph_table_count != vector_size( self->glyphs ) )
+    {
+        texture_font_update_glyph_table( self );
+    }
 
-        if( self->outline_type == 0 )
+    mask = self->glyph_table_capacity - 1;
+    i = texture_font_glyph_hash( charcode, outline_type, thickness,
+                                 phase ) & mask;
+    while( (glyph = self->glyph_table[i]) )
+    {
+        if( (glyph->charcode == charcode) &&
+            (glyph->outline_type == outline_type) &&
+            (THICKNESS_KEY(glyph->outline_thickness) == thickness) &&
+            (glyph->phase == phase) )
         {
-            slot            = face->glyph;
-            ft_bitmap       = slot->bitmap;
-            ft_bitmap_width = slot->bitmap.width;
-            ft_bitmap_rows  = slot->bitmap.rows;
-            ft_bitmap_pitch = slot->bitmap.pitch;
-            ft_glyph_top    = slot->bitmap_top;
-            ft_glyph_left   = slot->bitmap_left;
+            return glyph;
+        }
+        i = (i+1) & mask;
+    }
+    return NULL;
+}
+
+
+// ------------------------------------------ texture_font_activate_size ---
+// Fonts sharing a face switch sizes before using it (faces of the
+// rasterization threads are not shared)
+void
+texture_font_activate_size( texture_font_t * self )
+{
+    if( self->size_object && (self->size_object->face == self->face) &&
+        (self->face->size != self->size_object) )
+    {
+        FT_Activate_Size( self->size_object );
+    }
+}
+
+
+// -------------------------------------------- texture_font_glyph_index ---
+FT_UInt
+texture_font_glyph_index( texture_font_t * self,
+                          wchar_t charcode )
+{
+    if( self->shared && (self->shared->face == self->face) )
+    {
+        return font_registry_glyph_index( self->shared, charcode );
+    }
+    return FT_Get_Char_Index( self->face, charcode );
+}
+
+
+// ---------------------------------------------- texture_font_glyph_phase ---
+// Subpixel phase new glyphs are keyed with. Multi-channel distance fields
+// are never shifted (they are scaled and drawn at the exact pen position),
+// all their phases would be the same glyph.
+int
+texture_font_glyph_phase( const texture_font_t * self )
+{
+    if( (self->render_mode == TEXTURE_FONT_MULTI_DISTANCE_FIELD) &&
+        (self->atlas->depth == 3) && (self->outline_type == 0) )
+    {
+        return 0;
+    }
+    return self->phase;
+}
+
+
+// ----------------------------------------- texture_font_get_kerning_pairs ---
+vector_t *
+texture_font_get_kerning_pairs( texture_font_t * self )
+{
+    FT_Face face = self->face;
+    FT_ULong length = 0;
+    FT_Byte *table, *p, *end;
+    size_t i, count, subtables;
+    unsigned int coverage, size;
+    ivec2 pair;
+    vector_t *pairs;
+
+    // Kerning of other formats (e.g. Type 1 with AFM) can't be enumerated
+    if( !FT_IS_SFNT( face ) )
+    {
+        return NULL;
+    }
+    // Pairs are the same for all sizes
+    if( self->shared->kerning_pairs )
+    {
+        return self->shared->kerning_pairs;
+    }
+    pairs = self->shared->kerning_pairs = vector_new( sizeof(ivec2) );
+    if( FT_Load_Sfnt_Table( face, TTAG_kern, 0, NULL, &length ) || (length < 4) )
+    {
+        return pairs;
+    }
+    table = (FT_Byte *) malloc( length );
+    if( table == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    FT_Load_Sfnt_Table( face, TTAG_kern, 0, table, &length );
+
+    // Same subtables as FT_Get_Kerning: version 0, horizontal format 0
+    end = table + length;
+    p = table + 4;
+    subtables = (table[0] << 8 | table[1]) == 0 ? (table[2] << 8 | table[3]) : 0;
+    for( ; subtables && (p + 14 <= end); --subtables )
+    {
+        size     = p[2] << 8 | p[3];
+        coverage = p[4] << 8 | p[5];
+        count    = p[6] << 8 | p[7];
+        if( ((coverage & ~8U) == 0x0001) && (size >= 14) )
+        {
+            for( i=0; (i<count) && (p + 14 + 6*i + 6 <= end); ++i )
+            {
+                FT_Byte *entry = p + 14 + 6*i;
+                pair.x = entry[0] << 8 | entry[1];
+                pair.y = entry[2] << 8 | entry[3];
+                vector_push_back( pairs, &pair );
+            }
+        }
+        if( size < 6 )
+        {
+            break;
+        }
+        p += size;
+    }
+    free( table );
+    return pairs;
+}
+
+
+// ------------------------------------ texture_font_generate_kerning_pairs ---
+void
+texture_font_generate_kerning_pairs( texture_font_t * self,
+                                     const vector_t * pairs )
+{
+    size_t i, count = vector_size( self->glyphs );
+    int *first, *next, a, b;
+    ivec2 *pair;
+    texture_glyph_t *left, *right;
+    FT_Vector kerning;
+
+    // Glyphs sharing a glyph index (e.g. missing ones) are chained
+    first = (int *) malloc( (self->face->num_glyphs + count) * sizeof(int) );
+    if( first == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    next = first + self->face->num_glyphs;
+    for( i=0; i<(size_t)self->face->num_glyphs; ++i )
+    {
+        first[i] = -1;
+    }
+    for( i=0; i<count; ++i )
+    {
+        left = *(texture_glyph_t **) vector_get( self->glyphs, i );
+        next[i] = -1;
+        if( (left->charcode != (wchar_t)(-1)) &&
+            (left->glyph_index < (FT_UInt) self->face->num_glyphs) )
+        {
+            next[i] = first[left->glyph_index];
+            first[left->glyph_index] = i;
+        }
+    }
+
+    for( i=0; i<vector_size( pairs ); ++i )
+    {
+        pair = (ivec2 *) pairs->items + i;
+        if( (pair->x >= self->face->num_glyphs) ||
+            (pair->y >= self->face->num_glyphs) ||
+            (first[pair->x] < 0) || (first[pair->y] < 0) )
+        {
+            continue;
+        }
+        FT_Get_Kerning( self->face, pair->x, pair->y,
+                        FT_KERNING_UNFITTED, &kerning );
+        if( !kerning.x )
+        {
+            continue;
+        }
+        for( a=first[pair->x]; a>=0; a=next[a] )
+        {
+            for( b=first[pair->y]; b>=0; b=next[b] )
+            {
+                // Pairs of old glyphs are already known
+                if( ((size_t)a < self->kerning_count) &&
+                    ((size_t)b < self->kerning_count) )
+                {
+                    continue;
+                }
+                left = *(texture_glyph_t **) vector_get( self->glyphs, a );
+                right = *(texture_glyph_t **) vector_get( self->glyphs, b );
+                kerning_table_set( self->kerning_table,
+                                   left->charcode, right->charcode,
+                                   kerning.x / (float)(64.0f*64.0f) );
+            }
+        }
+    }
+    free( first );
+}
+
+
+// ------------------------------------------ texture_font_generate_kerning ---
+void
+texture_font_generate_kerning( texture_font_t *self )
+{
+    size_t i, j, count;
+    FT_Face face;
+    texture_glyph_t *glyph, *other;
+    FT_Vector kerning;
+    vector_t *pairs;
+
+    assert( self );
+
+    face = self->face;
+    if( !face )
+    {
+        return;
+    }
+    texture_font_activate_size( self );
+
+    count = vector_size( self->glyphs );
+    if( !FT_HAS_KERNING( face ) )
+    {
+        for( i=self->kerning_count; i<count; ++i )
+        {
+            glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
+            glyph->kerning_table = self->kerning_table;
+        }
+        self->kerning_count = count;
+        return;
+    }
+
+    /* Only pairs involving at least one new glyph need to be checked. Glyphs
+     * pushed directly in the glyphs vector may lack their glyph index. */
+    for( i=self->kerning_count; i<count; ++i )
+    {
+        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
+        glyph->kerning_table = self->kerning_table;
+        if( (glyph->glyph_index == 0) && (glyph->charcode != (wchar_t)(-1)) )
+        {
+            glyph->glyph_index = texture_font_glyph_index( self, glyph->charcode );
+        }
+    }
+
+    /* Checking every pair of glyphs is quadratic, large batches only look
+     * at the pairs listed in the font. */
+    pairs = texture_font_get_kerning_pairs( self );
+    if( pairs && ((count - self->kerning_count)*count > vector_size( pairs )) )
+    {
+        texture_font_generate_kerning_pairs( self, pairs );
+        self->kerning_count = count;
+        return;
+    }
+
+    for( i=self->kerning_count; i<count; ++i )
+    {
+        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
+        /* Skip the special background glyph */
+        if( glyph->charcode == (wchar_t)(-1) )
+        {
+            continue;
+        }
+
+        for( j=0; j<count; ++j )
+        {
+            other = *(texture_glyph_t **) vector_get( self->glyphs, j );
+            if( other->charcode == (wchar_t)(-1) )
+            {
+                continue;
+            }
+
+            // 64 * 64 because of 26.6 encoding AND the transform matrix used
+            // in texture_font_set_size (hres = 64)
+
+            /* other (old or new) on the left, new glyph on the right */
+            FT_Get_Kerning( face, other->glyph_index, glyph->glyph_index,
+                            FT_KERNING_UNFITTED, &kerning );
+            if( kerning.x )
+            {
+                kerning_table_set( self->kerning_table,
+                                   other->charcode, glyph->charcode,
+                                   kerning.x / (float)(64.0f*64.0f) );
+            }
+
+            /* new glyph on the left, old glyph on the right */
+            if( j < self->kerning_count )
+            {
+                FT_Get_Kerning( face, glyph->glyph_index, other->glyph_index,
+                                FT_KERNING_UNFITTED, &kerning );
+                if( kerning.x )
+                {
+                    kerning_table_set( self->kerning_table,
+                                       glyph->charcode, other->charcode,
+                                       kerning.x / (float)(64.0f*64.0f) );
+                }
+            }
+        }
+    }
+    self->kerning_count = count;
+}
+
+
+// ------------------------------------------- texture_font_atlas_resized ---
+void
+texture_font_atlas_resized( void * data,
+                            const size_t old_width,
+                            const size_t old_height,
+                            const size_t width,
+                            const size_t height )
+{
+    texture_font_t *self = (texture_font_t *) data;
+    float sx = old_width / (float) width;
+    float sy = old_height / (float) height;
+    size_t i;
+
+    assert( self );
+
+    for( i=0; i<vector_size( self->glyphs ); ++i )
+    {
+        texture_glyph_t *glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
+        glyph->s0 *= sx;
+        glyph->t0 *= sy;
+        glyph->s1 *= sx;
+        glyph->t1 *= sy;
+    }
+}
+
+
+// ----------------------------------------------------- texture_font_alloc ---
+// Font with default settings and no face yet (fonts loaded from a font
+// cache never get one)
+texture_font_t *
+texture_font_alloc( texture_atlas_t * atlas,
+                    const char * filename,
+                    const float size )
+{
+    texture_font_t *self = (texture_font_t *) malloc( sizeof(texture_font_t) );
+
+    if( self == NULL)
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->glyphs = vector_new( sizeof(texture_glyph_t *) );
+    self->glyph_table_capacity = 64;
+    self->glyph_table_count = 0;
+    self->glyph_table = (texture_glyph_t **)
+        calloc( self->glyph_table_capacity, sizeof(texture_glyph_t *) );
+    if( self->glyph_table == NULL)
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    self->atlas = atlas;
+    texture_atlas_add_listener( atlas, texture_font_atlas_resized, self );
+    self->height = 0;
+    self->ascender = 0;
+    self->descender = 0;
+    self->filename = strdup( filename );
+    self->file = NULL;
+    self->library = NULL;
+    self->library_owner = 0;
+    self->face = NULL;
+    self->shared = NULL;
+    self->size_object = NULL;
+    self->size = size;
+    self->outline_type = 0;
+    self->outline_thickness = 0.0;
+    self->subpixel_phases = 0;
+    self->phase = 0;
+    self->stroker = NULL;
+    self->render_mode = TEXTURE_FONT_BITMAP;
+    self->padding = 4;
+    self->distance_engine = DISTANCE_FIELD_EDTAA3;
+    self->hinting = 1;
+    self->kerning = 1;
+    self->kerning_table = kerning_table_new( 64 );
+    self->kerning_count = 0;
+    self->render_count = 0;
+    self->threads = 1;
+    self->worker_libraries = NULL;
+    self->worker_faces = NULL;
+    self->worker_strokers = NULL;
+    self->worker_count = 0;
+    self->async = 0;
+    self->queue = NULL;
+    self->filtering = 1;
+    // FT_LCD_FILTER_LIGHT   is (0x00, 0x55, 0x56, 0x55, 0x00)
+    // FT_LCD_FILTER_DEFAULT is (0x10, 0x40, 0x70, 0x40, 0x10)
+    self->lcd_weights[0] = 0x10;
+    self->lcd_weights[1] = 0x40;
+    self->lcd_weights[2] = 0x70;
+    self->lcd_weights[3] = 0x40;
+    self->lcd_weights[4] = 0x10;
+
+    return self;
+}
+
+
+// ------------------------------------------ texture_font_new_with_library ---
+texture_font_t *
+texture_font_new_with_library( texture_atlas_t * atlas,
+                               FT_Library library,
+                               const char * filename,
+                               const float size)
+{
+    texture_font_t *self;
+    FT_Face face;
+    FT_Size_Metrics metrics;
+    int hires;
+    
+    assert( library );
+    assert( filename );
+    assert( size );
+
+    self = texture_font_alloc( atlas, filename, size );
+    self->library = library;
+    self->file = font_registry_open( self->filename );
+    if( self->file )
+    {
+        self->shared = font_registry_open_face( self->file, self->library );
+    }
+    if( !self->shared )
+    {
+        return self;
+    }
+    face = self->shared->face;
+    if( FT_New_Size( face, &self->size_object ) ||
+        FT_Activate_Size( self->size_object ) ||
+        texture_font_set_size( face, self->size ) )
+    {
+        fprintf( stderr, "FT_Error (line %d) : cannot set size %.1f\n",
+                 __LINE__, self->size );
+        return self;
+    }
+    self->face = face;
+
+    /* Get font metrics at high resolution (falling back to the actual size
+     * when the face cannot be scaled that much) */
+    hires = 100;
+    if( texture_font_set_size( face, self->size*hires ) )
+    {
+        hires = 1;
+        texture_font_set_size( face, self->size );
+    }
+
+    // 64 * 64 because of 26.6 encoding AND the transform matrix used
+    // in texture_font_set_size (hres = 64)
+    self->underline_position = face->underline_position / (float)(64.0f*64.0f) * self->size;
+    self->underline_position = round( self->underline_position );
+    if( self->underline_position > -2 )
+    {
+        self->underline_position = -2.0;
+    }
+
+    self->underline_thickness = face->underline_thickness / (float)(64.0f*64.0f) * self->size;
+    self->underline_thickness = round( self->underline_thickness );
+    if( self->underline_thickness < 1 )
+    {
+        self->underline_thickness = 1.0;
+    }
+
+    metrics = face->size->metrics; 
+    self->ascender = (metrics.ascender >> 6) / (float) hires;
+    self->descender = (metrics.descender >> 6) / (float) hires;
+    self->height = (metrics.height >> 6) / (float) hires;
+    self->linegap = self->height - self->ascender + self->descender;
+
+    /* Back to the actual size for glyph loading */
+    if( hires != 1 )
+    {
+        texture_font_set_size( face, self->size );
+    }
+
+    /* -1 is a special glyph */
+    texture_font_get_glyph( self, -1 );
+
+    return self;
+}
+
+
+// ------------------------------------------------------- texture_font_new ---
+texture_font_t *
+texture_font_new( texture_atlas_t * atlas,
+                  const char * filename,
+                  const float size)
+{
+    texture_font_t *self;
+    FT_Library library;
+
+    assert( filename );
+    assert( size );
+
+    /* Library shared with other fonts, so is the face of the file */
+    library = font_registry_get_library( );
+    if( !library )
+    {
+        return NULL;
+    }
+
+    self = texture_font_new_with_library( atlas, library, filename, size );
+    self->library_owner = 1;
+    return self;
+}
+
+
+// Glyph rasterized in background: result is copied into glyph when committed
+typedef struct
+{
+    texture_glyph_t * glyph;
+    texture_glyph_t result;
+    unsigned char * buffer;
+    int error;
+} texture_font_request_t;
+
+
+struct texture_font_queue_t
+{
+    /** Font settings when last glyph was requested */
+    texture_font_t settings;
+
+    /** Rasterization thread own library, face and stroker */
+    FT_Library library;
+    FT_Face face;
+    FT_Stroker stroker;
+
+    platform_thread_t thread;
+    platform_mutex_t mutex;
+    platform_cond_t cond;
+
+    /** Requests (texture_font_request_t) waiting to be rasterized */
+    vector_t * requests;
+
+    /** Requests rasterized and waiting to be committed */
+    vector_t * ready;
+
+    /** Render calls made by the rasterization thread */
+    size_t render_count;
+
+    /** Whether rasterization thread has to stop */
+    int quit;
+};
+
+
+// -------------------------------------------- texture_font_queue_delete ---
+void
+texture_font_queue_delete( texture_font_queue_t * queue )
+{
+    size_t i;
+
+    platform_mutex_lock( &queue->mutex );
+    queue->quit = 1;
+    platform_cond_signal( &queue->cond );
+    platform_mutex_unlock( &queue->mutex );
+    platform_thread_join( queue->thread );
+
+    for( i=0; i<vector_size( queue->ready ); ++i )
+    {
+        free( ((texture_font_request_t *) vector_get( queue->ready, i ))->buffer );
+    }
+    vector_delete( queue->requests );
+    vector_delete( queue->ready );
+    platform_cond_destroy( &queue->cond );
+    platform_mutex_destroy( &queue->mutex );
+    free( queue );
+}
+
+
+// ---------------------------------------------------- texture_font_delete ---
+void
+texture_font_delete( texture_font_t *self )
+{
+    size_t i;
+    texture_glyph_t *glyph;
+
+    assert( self );
+
+    if( self->filename )
+    {
+        free( self->filename );
+    }
+
+
+    for( i=0; i<vector_size( self->glyphs ); ++i)
+    {
+        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
+        texture_glyph_delete( glyph);
+    }
+
+    vector_delete( self->glyphs );
+    free( self->glyph_table );
+    texture_atlas_remove_listener( self->atlas, texture_font_atlas_resized, self );
+    kerning_table_delete( self->kerning_table );
+    if( self->queue )
+    {
+        texture_font_queue_delete( self->queue );
+    }
+    for( i=0; i<self->worker_count; ++i )
+    {
+        if( self->worker_strokers[i] )
+        {
+            FT_Stroker_Done( self->worker_strokers[i] );
+        }
+        FT_Done_Face( self->worker_faces[i] );
+        FT_Done_FreeType( self->worker_libraries[i] );
+    }
+    free( self->worker_strokers );
+    free( self->worker_faces );
+    free( self->worker_libraries );
+    if( self->stroker )
+    {
+        FT_Stroker_Done( self->stroker );
+    }
+
+    if( self->shared )
+    {
+        if( self->size_object )
+        {
+            FT_Done_Size( self->size_object );
+        }
+        font_registry_close_face( self->file, self->shared );
+    }
+    if( self->library_owner )
+    {
+        font_registry_release_library( );
+    }
+    // After faces, which use its content
+    if( self->file )
+    {
+        font_registry_close( self->file );
+    }
+    free( self );
+}
+
+
+// --------------------------------------- texture_font_make_distance_field ---
+void
+texture_font_make_distance_field( texture_font_t * self,
+                                  texture_glyph_t * glyph,
+                                  unsigned char ** buffer )
+{
+    size_t i, padding = self->padding ? self->padding : 1;
+    size_t width = glyph->width + 2*padding;
+    size_t height = glyph->height + 2*padding;
+    unsigned char *field;
+
+    field = (unsigned char *) calloc( width*height + 1, 1 );
+    if( field == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    for( i=0; i<glyph->height; ++i )
+    {
+        memcpy( field + (i+padding)*width + padding,
+                *buffer + i*glyph->width, glyph->width );
+    }
+    // Largest encoded distance is the padding
+    make_distance_field( field, field, width, height, 128.0/padding,
+                         self->distance_engine );
+    free( *buffer );
+    *buffer = field;
+
+    glyph->width = width;
+    glyph->height = height;
+    glyph->offset_x -= padding;
+    glyph->offset_y += padding;
+}
+
+
+// --------------------------------- texture_font_make_multi_distance_field ---
+// Multi-channel distance field of the outline loaded in the glyph slot,
+// padded for the field to fade out before the region border
+void
+texture_font_make_multi_distance_field( texture_font_t * self,
+                                        texture_glyph_t * glyph,
+                                        unsigned char ** buffer )
+{
+    FT_Outline *outline = &self->face->glyph->outline;
+    size_t padding = self->padding ? self->padding : 1;
+    FT_BBox bbox;
+
+    glyph->width = glyph->height = 0;
+    glyph->offset_x = glyph->offset_y = 0;
+    if( outline->n_points )
+    {
+        FT_Outline_Get_CBox( outline, &bbox );
+        glyph->offset_x = (int)( floor( bbox.xMin / 64.0 ) - padding );
+        glyph->offset_y = (int)( ceil( bbox.yMax / 64.0 ) + padding );
+        glyph->width = (size_t)( ceil( bbox.xMax / 64.0 ) + padding
+                                 - glyph->offset_x );
+        glyph->height = (size_t)( glyph->offset_y
+                                  - floor( bbox.yMin / 64.0 ) + padding );
+    }
+    *buffer = (unsigned char *) malloc( glyph->width*glyph->height*3 + 1 );
+    if( *buffer == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    if( outline->n_points )
+    {
+        // Largest encoded distance is the padding
+        make_multi_distance_field( outline, *buffer,
+                                   glyph->width, glyph->height,
+                                   glyph->offset_x, glyph->offset_y,
+                                   128.0/padding );
+    }
+    glyph->outline_type = 0;
+    glyph->outline_thickness = 0;
+}
+
+
+// ---------------------------------------------- texture_font_render_glyph ---
+int
+texture_font_render_glyph( texture_font_t * self,
+                           texture_glyph_t * glyph,
+                           unsigned char ** buffer )
+{
+    size_t i, depth;
+    FT_Library library;
+    FT_Error error;
+    FT_Face face;
+    FT_Glyph ft_glyph = NULL;
+    FT_GlyphSlot slot;
+    FT_Bitmap ft_bitmap;
+    FT_Int32 flags = 0;
+    int ft_glyph_top = 0;
+    int ft_glyph_left = 0;
+    int multi;
+    FT_Pos shift = 0;
+
+    assert( self );
+    assert( glyph );
+    assert( buffer );
+
+    depth   = self->atlas->depth;
+    library = self->library;
+    face    = self->face;
+    multi   = (self->render_mode == TEXTURE_FONT_MULTI_DISTANCE_FIELD) &&
+              (depth == 3) && (self->outline_type == 0);
+    glyph->phase = texture_font_glyph_phase( self );
+
+    // Glyphs of a subpixel phase are rendered from their outline, moved
+    // right by a fraction of pixel (26.6)
+    if( (self->subpixel_phases > 1) && !multi )
+    {
+        shift = self->phase * 64 / (FT_Pos) self->subpixel_phases;
+    }
+
+    glyph->glyph_index = texture_font_glyph_index( self, glyph->charcode );
+    texture_font_activate_size( self );
+    // WARNING: We use texture-atlas depth to guess if user wants
+    //          LCD subpixel rendering
+
+    if( (self->outline_type > 0) || multi || shift )
+    {
+        flags |= FT_LOAD_NO_BITMAP;
+    }
+    else
+    {
+        flags |= FT_LOAD_RENDER;
+    }
+
+    if( !self->hinting )
+    {
+        flags |= FT_LOAD_NO_HINTING | FT_LOAD_NO_AUTOHINT;
+    }
+    else
+    {
+        flags |= FT_LOAD_FORCE_AUTOHINT;
+    }
+
+
+    if( (depth == 3) && !multi )
+    {
+        FT_Library_SetLcdFilter( library, FT_LCD_FILTER_LIGHT );
+        flags |= FT_LOAD_TARGET_LCD;
+        if( self->filtering )
+        {
+            FT_Library_SetLcdFilterWeights( library, self->lcd_weights );
+        }
+    }
+    error = FT_Load_Glyph( face, glyph->glyph_index, flags );
+    if( flags & FT_LOAD_RENDER )
+    {
+        self->render_count++;
+    }
+    if( error )
+    {
+        fprintf( stderr, "FT_Error (line %d, code 0x%02x) : %s\n",
+                 __LINE__, FT_Errors[error].code, FT_Errors[error].message );
+        return error;
+    }
+
+    // Unhinted advance (16.16) comes for free with the hinted glyph. It
+    // is expressed at the horizontal resolution used in
+    // texture_font_set_size (hres = 64).
+    glyph->advance_x = face->glyph->linearHoriAdvance / (float)(65536.0f*64.0f);
+    glyph->advance_y = face->glyph->advance.y/64.0;
+
+    if( multi )
+    {
+        texture_font_make_multi_distance_field( self, glyph, buffer );
+        return 0;
+    }
+
+    if( self->outline_type == 0 )
+    {
+        slot            = face->glyph;
+        if( shift )
+        {
+            FT_Outline_Translate( &slot->outline, shift, 0 );
+            error = FT_Render_Glyph( slot, depth == 3 ? FT_RENDER_MODE_LCD
+                                                      : FT_RENDER_MODE_NORMAL );
+            self->render_count++;
+            if( error )
+            {
+                fprintf(stderr, "FT_Error (0x%02x) : %s\n",
+                        FT_Errors[error].code, FT_Errors[error].message);
+                return error;
+            }
+        }
+        ft_bitmap       = slot->bitmap;
+        ft_glyph_top    = slot->bitmap_top;
+        ft_glyph_left   = slot->bitmap_left;
+    }
+    else
+    {
+        FT_Stroker stroker;
+        FT_BitmapGlyph ft_bitmap_glyph;
+        // Stroker (and the memory of its borders) is reused across glyphs,
+        // setting it is cheap.
+        if( !self->stroker )
+        {
+            error = FT_Stroker_New( library, &self->stroker );
+            if( error )
+            {
+                fprintf(stderr, "FT_Error (0x%02x) : %s\n",
+                        FT_Errors[error].code, FT_Errors[error].message);
+                self->stroker = NULL;
+                return error;
+            }
+        }
+        stroker = self->stroker;
+        FT_Stroker_Set( stroker,
+                        (int)(self->outline_thickness *64),
+                        FT_STROKER_LINECAP_ROUND,
+                        FT_STROKER_LINEJOIN_ROUND,
+                        0);
+        if( shift )
+        {
+            FT_Outline_Translate( &face->glyph->outline, shift, 0 );
+        }
+        error = FT_Get_Glyph( face->glyph, &ft_glyph);
+        if( error )
+        {
+            fprintf(stderr, "FT_Error (0x%02x) : %s\n",
+                    FT_Errors[error].code, FT_Errors[error].message);
+            return error;
+        }
+
+        if( self->outline_type == 1 )
+        {
+            error = FT_Glyph_Stroke( &ft_glyph, stroker, 1 );
+        }
+        else if ( self->outline_type == 2 )
+        {
+            error = FT_Glyph_StrokeBorder( &ft_glyph, stroker, 0, 1 );
+        }
+        else if ( self->outline_type == 3 )
+        {
+            error = FT_Glyph_StrokeBorder( &ft_glyph, stroker, 1, 1 );
+        }
+        if( error )
+        {
+            fprintf(stderr, "FT_Error (0x%02x) : %s\n",
+                    FT_Errors[error].code, FT_Errors[error].message);
+            FT_Done_Glyph( ft_glyph );
+            return error;
+        }
+
+        if( depth == 1)
+        {
+            error = FT_Glyph_To_Bitmap( &ft_glyph, FT_RENDER_MODE_NORMAL, 0, 1);
+        }
+        else
+        {
+            error = FT_Glyph_To_Bitmap( &ft_glyph, FT_RENDER_MODE_LCD, 0, 1);
+        }
+        self->render_count++;
+        if( error )
+        {
+            fprintf(stderr, "FT_Error (0x%02x) : %s\n",
+                    FT_Errors[error].code, FT_Errors[error].message);
+            FT_Done_Glyph( ft_glyph );
+            return error;
+        }
+        ft_bitmap_glyph = (FT_BitmapGlyph) ft_glyph;
+        ft_bitmap       = ft_bitmap_glyph->bitmap;
+        ft_glyph_top    = ft_bitmap_glyph->top;
+        ft_glyph_left   = ft_bitmap_glyph->left;
+    }
+
+    glyph->width    = ft_bitmap.width/depth;
+    glyph->height   = ft_bitmap.rows;
+    glyph->outline_type = self->outline_type;
+    glyph->outline_thickness = self->outline_thickness;
+    glyph->offset_x = ft_glyph_left;
+    glyph->offset_y = ft_glyph_top;
+
+    // Bitmap belongs to the glyph slot (or the stroked glyph) and would be
+    // overwritten by the next glyph, rows are copied without padding.
+    *buffer = (unsigned char *) malloc( ft_bitmap.rows*ft_bitmap.width + 1 );
+    if( *buffer == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+    for( i=0; i<ft_bitmap.rows; ++i )
+    {
+        memcpy( *buffer + i*ft_bitmap.width,
+                ft_bitmap.buffer + (int)i*ft_bitmap.pitch, ft_bitmap.width );
+    }
+    if( ft_glyph )
+    {
+        FT_Done_Glyph( ft_glyph );
+    }
+
+    // Distance field is computed on the glyph own bitmap, padded for the
+    // field to fade out before the region border
+    if( (self->render_mode == TEXTURE_FONT_DISTANCE_FIELD) && (depth == 1) &&
+        glyph->width && glyph->height )
+    {
+        texture_font_make_distance_field( self, glyph, buffer );
+    }
+    return 0;
+}
+
+
+// ------------------------------------------------ texture_font_place_glyph ---
+int
+texture_font_place_glyph( texture_font_t * self,
+                          texture_glyph_t * glyph,
+                          const unsigned char * buffer )
+{
+    ivec4 region;
+
+    // We want each glyph to be separated by at least one black pixel
+    // (for example for shader used in demo-subpixel.c)
+    region = texture_atlas_get_region( self->atlas,
+                                       glyph->width + 1, glyph->height + 1 );
+    if ( region.x < 0 )
+    {
+        fprintf( stderr, "Texture atlas is full (line %d)\n",  __LINE__ );
+        return 0;
+    }
+    texture_atlas_set_region( self->atlas, region.x, region.y,
+                              glyph->width, glyph->height,
+                              buffer, glyph->width*self->atlas->depth );
+    glyph->last_used = ++self->atlas->clock;
+    // Atlas may have grown while getting region
+    texture_font_set_glyph_region( self, glyph, region );
+    return 1;
+}
+
+
+// ----------------------------------------------- texture_font_load_glyphs ---
+size_t
+texture_font_load_glyphs( texture_font_t * self,
+                          const wchar_t * charcodes )
+{
+    size_t i, length;
+    texture_glyph_t *glyph;
+    unsigned char *buffer;
+    size_t missed = 0;
+
+    assert( self );
+    assert( charcodes );
+
+    length = wcslen(charcodes);
+    if( !self->face )
+    {
+        return length;
+    }
+
+    /* Load each glyph */
+    for( i=0; i<length; ++i )
+    {
+        /* Skip glyphs that have already been loaded */
+        if( texture_font_find_glyph( self, charcodes[i], self->outline_type,
+                                     self->outline_thickness,
+                                     texture_font_glyph_phase( self ) ) )
+        {
+            continue;
+        }
+
+        glyph = texture_glyph_new( );
+        glyph->charcode = charcodes[i];
+        if( texture_font_render_glyph( self, glyph, &buffer ) )
+        {
+            texture_glyph_delete( glyph );
+            return length-i;
+        }
+        if( texture_font_place_glyph( self, glyph, buffer ) )
+        {
+            vector_push_back( self->glyphs, &glyph );
         }
         else
         {
-            FT_Stroker stroker;
-            FT_BitmapGlyph ft_bitmap_glyph;
-            error = FT_Stroker_New( library, &stroker );
-            if( error )
-            {
-                fprintf(stderr, "FT_Error (0x%02x) : %s\n",
-                        FT_Errors[error].code, FT_Errors[error].message);
-                FT_Done_Face( face );
-                FT_Stroker_Done( stroker );
-                FT_Done_FreeType( library );
-                return 0;
-            }
-            FT_Stroker_Set( stroker,
-                            (int)(self->outline_thickness *64),
-                            FT_STROKER_LINECAP_ROUND,
-                            FT_STROKER_LINEJOIN_ROUND,
-                            0);
-            error = FT_Get_Glyph( face->glyph, &ft_glyph);
-            if( error )
-            {
-                fprintf(stderr, "FT_Error (0x%02x) : %s\n",
-                        FT_Errors[error].code, FT_Errors[error].message);
-                FT_Done_Face( face );
-                FT_Stroker_Done( stroker );
-                FT_Done_FreeType( library );
-                return 0;
-            }
+            texture_glyph_delete( glyph );
+            missed++;
+        }
+        free( buffer );
+    }
+    texture_atlas_upload( self->atlas );
+    texture_font_generate_kerning( self );
+    return missed;
+}
+
+
+// Rasterized glyph waiting to be placed by texture_font_load_charset
+typedef struct
+{
+    texture_glyph_t * glyph;
+    unsigned char * buffer;
+} texture_font_batch_t;
+
+
+// ---------------------------------------------- texture_font_batch_compare ---
+int
+texture_font_batch_compare( const void * a,
+                            const void * b )
+{
+    const texture_glyph_t *g1 = ((const texture_font_batch_t *) a)->glyph;
+    const texture_glyph_t *g2 = ((const texture_font_batch_t *) b)->glyph;
+
+    if( g1->height != g2->height )
+    {
+        return g2->height > g1->height ? 1 : -1;
+    }
+    if( g1->width != g2->width )
+    {
+        return g2->width > g1->width ? 1 : -1;
+    }
+    return (g1->charcode > g2->charcode) - (g1->charcode < g2->charcode);
+}
+
+
+// -------------------------------------------- texture_font_charcode_compare ---
+int
+texture_font_charcode_compare( const void * a,
+                               const void * b )
+{
+    wchar_t c1 = ((const texture_font_batch_t *) a)->glyph->charcode;
+    wchar_t c2 = ((const texture_font_batch_t *) b)->glyph->charcode;
+
+    return (c1 > c2) - (c1 < c2);
+}
+
+
+// Rasterization thread: renders every step-th glyph of the batch
+typedef struct
+{
+    texture_font_t font;
+    texture_font_batch_t * batch;
+    size_t first, step, count;
+} texture_font_worker_t;
+
+
+// ------------------------------------------------- texture_font_rasterize ---
+void
+texture_font_rasterize( void * data )
+{
+    texture_font_worker_t *worker = (texture_font_worker_t *) data;
+    size_t i;
+    texture_font_batch_t *item;
+
+    for( i=worker->first; i<worker->count; i+=worker->step )
+    {
+        item = worker->batch + i;
+        if( texture_font_render_glyph( &worker->font, item->glyph, &item->buffer ) )
+        {
+            item->buffer = NULL;
+        }
+    }
+}
 
-            if( self->outline_type == 1 )
-            {
-                error = FT_Glyph_Stroke( &ft_glyph, stroker, 1 );
-            }
-            else if ( self->outline_type == 2 )
-            {
-                error = FT_Glyph_StrokeBorder( &ft_glyph, stroker, 0, 1 );
-            }
-            else if ( self->outline_type == 3 )
-            {
-                error = FT_Glyph_StrokeBorder( &ft_glyph, stroker, 1, 1 );
-            }
-            if( error )
+// --------------------------------------------- texture_font_rasterize_batch ---
+void
+texture_font_rasterize_batch( texture_font_t * self,
+                              texture_font_batch_t * batch,
+                              const size_t count )
+{
+    size_t i, started, threads = self->threads;
+    texture_font_worker_t *workers;
+    platform_thread_t *handles;
+
+    if( threads > count )
+    {
+        threads = count;
+    }
+    if( threads < 2 )
+    {
+        for( i=0; i<count; ++i )
+        {
+            if( texture_font_render_glyph( self, batch[i].glyph, &batch[i].buffer ) )
             {
-                fprintf(stderr, "FT_Error (0x%02x) : %s\n",
-                        FT_Errors[error].code, FT_Errors[error].message);
-                FT_Done_Face( face );
-                FT_Stroker_Done( stroker );
-                FT_Done_FreeType( library );
-                return 0;
+                batch[i].buffer = NULL;
             }
-          
-            if( depth == 1)
+        }
+        return;
+    }
+
+    // Each worker owns a face (faces are kept for next batches)
+    if( self->worker_count < threads-1 )
+    {
+        self->worker_libraries = (FT_Library *)
+            realloc( self->worker_libraries, (threads-1)*sizeof(FT_Library) );
+        self->worker_faces = (FT_Face *)
+            realloc( self->worker_faces, (threads-1)*sizeof(FT_Face) );
+        self->worker_strokers = (FT_Stroker *)
+            realloc( self->worker_strokers, (threads-1)*sizeof(FT_Stroker) );
+        if( (self->worker_libraries == NULL) || (self->worker_faces == NULL) ||
+            (self->worker_strokers == NULL) )
+        {
+            fprintf( stderr,
+                     "line %d: No more memory for allocating data\n", __LINE__ );
+            exit( EXIT_FAILURE );
+        }
+        for( ; self->worker_count < threads-1; ++self->worker_count )
+        {
+            FT_Library *library = self->worker_libraries + self->worker_count;
+            if( FT_Init_FreeType( library ) )
             {
-                error = FT_Glyph_To_Bitmap( &ft_glyph, FT_RENDER_MODE_NORMAL, 0, 1);
-                if( error )
-                {
-                    fprintf(stderr, "FT_Error (0x%02x) : %s\n",
-                            FT_Errors[error].code, FT_Errors[error].message);
-                    FT_Done_Face( face );
-                    FT_Stroker_Done( stroker );
-                    FT_Done_FreeType( library );
-                    return 0;
-                }
+                break;
             }
-            else
+            if( !texture_font_load_face( *library, self->file, self->size,
+                                         self->worker_faces + self->worker_count ) )
             {
-                error = FT_Glyph_To_Bitmap( &ft_glyph, FT_RENDER_MODE_LCD, 0, 1);
-                if( error )
-                {
-                    fprintf(stderr, "FT_Error (0x%02x) : %s\n",
-                            FT_Errors[error].code, FT_Errors[error].message);
-                    FT_Done_Face( face );
-                    FT_Stroker_Done( stroker );
-                    FT_Done_FreeType( library );
-                    return 0;
-                }
+                FT_Done_FreeType( *library );
+                break;
             }
-            ft_bitmap_glyph = (FT_BitmapGlyph) ft_glyph;
-            ft_bitmap       = ft_bitmap_glyph->bitmap;
-            ft_bitmap_width = ft_bitmap.width;
-            ft_bitmap_rows  = ft_bitmap.rows;
-            ft_bitmap_pitch = ft_bitmap.pitch;
-            ft_glyph_top    = ft_bitmap_glyph->top;
-            ft_glyph_left   = ft_bitmap_glyph->left;
-            FT_Stroker_Done(stroker);
-        }
-
-
-        // We want each glyph to be separated by at least one black pixel
-        // (for example for shader used in demo-subpixel.c)
-        w = ft_bitmap_width/depth + 1;
-        h = ft_bitmap_rows + 1;
-        region = texture_atlas_get_region( self->atlas, w, h );
-        if ( region.x < 0 )
+            self->worker_strokers[self->worker_count] = NULL;
+        }
+        threads = self->worker_count + 1;
+    }
+
+    workers = (texture_font_worker_t *)
+        malloc( threads*sizeof(texture_font_worker_t) );
+    handles = (platform_thread_t *) malloc( threads*sizeof(platform_thread_t) );
+    if( (workers == NULL) || (handles == NULL) )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
+
+    // Glyphs are interleaved (batch is sorted by charcode) for the load to
+    // be balanced. Calling thread works with the font own face.
+    for( i=0; i<threads; ++i )
+    {
+        workers[i].font = *self;
+        workers[i].font.render_count = 0;
+        if( i > 0 )
         {
-            missed++;
-            fprintf( stderr, "Texture atlas is full (line %d)\n",  __LINE__ );
-            continue;
+            workers[i].font.library = self->worker_libraries[i-1];
+            workers[i].font.face = self->worker_faces[i-1];
+            workers[i].font.stroker = self->worker_strokers[i-1];
+        }
+        workers[i].batch = batch;
+        workers[i].first = i;
+        workers[i].step = threads;
+        workers[i].count = count;
+    }
+    for( started=1; started<threads; ++started )
+    {
+        if( !platform_thread_create( handles + started, texture_font_rasterize,
+                                     workers + started ) )
+        {
+            break;
         }
-        w = w - 1;
-        h = h - 1;
-        x = region.x;
-        y = region.y;
-        texture_atlas_set_region( self->atlas, x, y, w, h,
-                                  ft_bitmap.buffer, ft_bitmap.pitch );
+    }
+    // Calling thread also takes over threads that could not be started
+    texture_font_rasterize( workers );
+    for( i=started; i<threads; ++i )
+    {
+        texture_font_rasterize( workers + i );
+    }
+    for( i=1; i<started; ++i )
+    {
+        platform_thread_join( handles[i] );
+    }
+    // Keep strokers created by the workers
+    self->stroker = workers[0].font.stroker;
+    for( i=0; i<threads; ++i )
+    {
+        self->render_count += workers[i].font.render_count;
+        if( i > 0 )
+        {
+            self->worker_strokers[i-1] = workers[i].font.stroker;
+        }
+    }
+    free( handles );
+    free( workers );
+}
+
+
+// ------------------------------------------------ texture_font_load_charset ---
+size_t
+texture_font_load_charset( texture_font_t * self,
+                           const wchar_t * charcodes )
+{
+    size_t i, length;
+    texture_glyph_t *glyph;
+    texture_font_batch_t *batch;
+    size_t missed = 0, count = 0;
+
+    assert( self );
+    assert( charcodes );
+
+    length = wcslen(charcodes);
+    if( !self->face )
+    {
+        return length;
+    }
+
+    batch = (texture_font_batch_t *)
+        malloc( (length+1)*sizeof(texture_font_batch_t) );
+    if( batch == NULL )
+    {
+        fprintf( stderr,
+                 "line %d: No more memory for allocating data\n", __LINE__ );
+        exit( EXIT_FAILURE );
+    }
 
+    // Skip loaded glyphs and duplicate charcodes
+    for( i=0; i<length; ++i )
+    {
+        if( texture_font_find_glyph( self, charcodes[i], self->outline_type,
+                                     self->outline_thickness,
+                                     texture_font_glyph_phase( self ) ) )
+        {
+            continue;
+        }
         glyph = texture_glyph_new( );
         glyph->charcode = charcodes[i];
-        glyph->width    = w;
-        glyph->height   = h;
-        glyph->outline_type = self->outline_type;
-        glyph->outline_thickness = self->outline_thickness;
-        glyph->offset_x = ft_glyph_left;
-        glyph->offset_y = ft_glyph_top;
-        glyph->s0       = x/(float)width;
-        glyph->t0       = y/(float)height;
-        glyph->s1       = (x + glyph->width)/(float)width;
-        glyph->t1       = (y + glyph->height)/(float)height;
-
-        // Discard hinting to get advance
-        FT_Load_Glyph( face, glyph_index, FT_LOAD_RENDER | FT_LOAD_NO_HINTING);
-        slot = face->glyph;
-        glyph->advance_x = slot->advance.x/64.0;
-        glyph->advance_y = slot->advance.y/64.0;
+        batch[count++].glyph = glyph;
+    }
+    qsort( batch, count, sizeof(texture_font_batch_t),
+           texture_font_charcode_compare );
+    for( i=1, length=count, count=count ? 1 : 0; i<length; ++i )
+    {
+        if( batch[i].glyph->charcode == batch[count-1].glyph->charcode )
+        {
+            texture_glyph_delete( batch[i].glyph );
+            continue;
+        }
+        batch[count++] = batch[i];
+    }
 
-        vector_push_back( self->glyphs, &glyph );
+    // Rasterize everything first
+    texture_font_rasterize_batch( self, batch, count );
 
-        if( self->outline_type > 0 )
+    // Tallest (then widest) glyphs first leave the flattest skyline
+    qsort( batch, count, sizeof(texture_font_batch_t),
+           texture_font_batch_compare );
+    for( i=0; i<count; ++i )
+    {
+        if( batch[i].buffer &&
+            texture_font_place_glyph( self, batch[i].glyph, batch[i].buffer ) )
         {
-            FT_Done_Glyph( ft_glyph );
+            vector_push_back( self->glyphs, &batch[i].glyph );
         }
+        else
+        {
+            texture_glyph_delete( batch[i].glyph );
+            missed++;
+        }
+        free( batch[i].buffer );
     }
-    FT_Done_Face( face );
-    FT_Done_FreeType( library );
+    free( batch );
+
     texture_atlas_upload( self->atlas );
     texture_font_generate_kerning( self );
     return missed;
 }
 
 
+// ------------------------------------------ texture_font_get_glyph_region ---
+ivec4
+texture_font_get_glyph_region( const texture_font_t * self,
+                               const texture_glyph_t * glyph )
+{
+    ivec4 region;
+    size_t width, height;
+
+    assert( self );
+    assert( glyph );
+
+    width  = self->atlas->width;
+    height = self->atlas->height;
+    region.x = (int)(glyph->s0*width + .5f);
+    region.y = (int)(glyph->page*height) + (int)(glyph->t0*height + .5f);
+    if( glyph->charcode == (wchar_t)(-1) )
+    {
+        // Texture coordinates point to the center of a 5x5 region
+        region.x -= 2;
+        region.y -= 2;
+        region.width = 5;
+        region.height = 5;
+    }
+    else
+    {
+        region.width = glyph->width + 1;
+        region.height = glyph->height + 1;
+    }
+    return region;
+}
+
+
+// ------------------------------------------ texture_font_set_glyph_region ---
+void
+texture_font_set_glyph_region( const texture_font_t * self,
+                               texture_glyph_t * glyph,
+                               const ivec4 region )
+{
+    size_t x, y, width, height;
+
+    assert( self );
+    assert( glyph );
+
+    width  = self->atlas->width;
+    height = self->atlas->height;
+    glyph->page = region.y / height;
+    x = region.x;
+    y = region.y - glyph->page * height;
+    if( glyph->charcode == (wchar_t)(-1) )
+    {
+        glyph->s0 = (x+2)/(float)width;
+        glyph->t0 = (y+2)/(float)height;
+        glyph->s1 = (x+3)/(float)width;
+        glyph->t1 = (y+3)/(float)height;
+    }
+    else
+    {
+        glyph->s0 = x/(float)width;
+        glyph->t0 = y/(float)height;
+        glyph->s1 = (x + glyph->width)/(float)width;
+        glyph->t1 = (y + glyph->height)/(float)height;
+    }
+}
+
+
+// --------------------------------------------- texture_font_remove_glyphs ---
+size_t
+texture_font_remove_glyphs( texture_font_t * self,
+                            const size_t before )
+{
+    size_t i, j, kerning_count;
+    texture_glyph_t *glyph;
+
+    assert( self );
+
+    kerning_count = self->kerning_count;
+    for( i=0, j=0; i<vector_size( self->glyphs ); ++i )
+    {
+        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
+        if( (glyph->last_used >= before) || glyph->pending ||
+            (glyph->charcode == (wchar_t)(-1)) )
+        {
+            vector_set( self->glyphs, j++, &glyph );
+            continue;
+        }
+        texture_atlas_free_region( self->atlas,
+                                   texture_font_get_glyph_region( self, glyph ) );
+        texture_glyph_delete( glyph );
+        // Kerning pairs are kept (they are indexed by charcode) but
+        // remaining glyphs shift down.
+        if( i < self->kerning_count )
+        {
+            --kerning_count;
+        }
+    }
+    self->kerning_count = kerning_count;
+    i = vector_size( self->glyphs ) - j;
+    vector_resize( self->glyphs, j );
+    if( i )
+    {
+        self->glyph_table_count = (size_t)(-1);
+    }
+    return i;
+}
+
+
+// --------------------------------------------- texture_font_queue_main ---
+void
+texture_font_queue_main( void * data )
+{
+    texture_font_queue_t *queue = (texture_font_queue_t *) data;
+    texture_font_request_t request;
+    texture_font_t font;
+    int loaded;
+
+    // Face is created here not to block the caller
+    platform_mutex_lock( &queue->mutex );
+    font = queue->settings;
+    platform_mutex_unlock( &queue->mutex );
+    loaded = !FT_Init_FreeType( &queue->library );
+    if( loaded && !texture_font_load_face( queue->library, font.file,
+                                           font.size, &queue->face ) )
+    {
+        FT_Done_FreeType( queue->library );
+        loaded = 0;
+    }
+
+    platform_mutex_lock( &queue->mutex );
+    for( ;; )
+    {
+        while( !queue->quit && !vector_size( queue->requests ) )
+        {
+            platform_cond_wait( &queue->cond, &queue->mutex );
+        }
+        if( queue->quit )
+        {
+            break;
+        }
+        request = *(texture_font_request_t *) vector_front( queue->requests );
+        vector_erase( queue->requests, 0 );
+        font = queue->settings;
+        platform_mutex_unlock( &queue->mutex );
+
+        request.error = 1;
+        request.buffer = NULL;
+        if( loaded )
+        {
+            font.library = queue->library;
+            font.face = queue->face;
+            font.stroker = queue->stroker;
+            font.render_count = 0;
+            font.outline_type = request.result.outline_type;
+            font.outline_thickness = request.result.outline_thickness;
+            font.phase = request.result.phase;
+            request.error = texture_font_render_glyph( &font, &request.result,
+                                                       &request.buffer );
+            queue->stroker = font.stroker;
+        }
+
+        platform_mutex_lock( &queue->mutex );
+        queue->render_count += font.render_count;
+        vector_push_back( queue->ready, &request );
+    }
+    platform_mutex_unlock( &queue->mutex );
+
+    if( loaded )
+    {
+        if( queue->stroker )
+        {
+            FT_Stroker_Done( queue->stroker );
+        }
+        FT_Done_Face( queue->face );
+        FT_Done_FreeType( queue->library );
+    }
+}
+
+
+// ------------------------------------------- texture_font_request_glyph ---
+texture_glyph_t *
+texture_font_request_glyph( texture_font_t * self,
+                            const wchar_t charcode )
+{
+    texture_font_request_t request;
+    texture_glyph_t *glyph;
+    FT_Fixed advance;
+
+    if( !self->face )
+    {
+        return NULL;
+    }
+    if( !self->queue )
+    {
+        self->queue = (texture_font_queue_t *)
+            calloc( 1, sizeof(texture_font_queue_t) );
+        if( self->queue == NULL )
+        {
+            fprintf( stderr,
+                     "line %d: No more memory for allocating data\n", __LINE__ );
+            exit( EXIT_FAILURE );
+        }
+        self->queue->settings = *self;
+        self->queue->requests = vector_new( sizeof(texture_font_request_t) );
+        self->queue->ready = vector_new( sizeof(texture_font_request_t) );
+        platform_mutex_init( &self->queue->mutex );
+        platform_cond_init( &self->queue->cond );
+        if( !platform_thread_create( &self->queue->thread,
+                                     texture_font_queue_main, self->queue ) )
+        {
+            vector_delete( self->queue->requests );
+            vector_delete( self->queue->ready );
+            platform_cond_destroy( &self->queue->cond );
+            platform_mutex_destroy( &self->queue->mutex );
+            free( self->queue );
+            self->queue = NULL;
+            self->async = 0;
+            return NULL;
+        }
+    }
+
+    // Glyph is usable right away for layout: unhinted advance (which is
+    // the final one) only needs the metrics table.
+    glyph = texture_glyph_new( );
+    glyph->charcode = charcode;
+    glyph->glyph_index = texture_font_glyph_index( self, charcode );
+    texture_font_activate_size( self );
+    glyph->outline_type = self->outline_type;
+    glyph->outline_thickness = self->outline_thickness;
+    glyph->phase = texture_font_glyph_phase( self );
+    glyph->pending = 1;
+    glyph->last_used = ++self->atlas->clock;
+    if( !FT_Get_Advance( self->face, glyph->glyph_index,
+                         FT_LOAD_NO_HINTING, &advance ) )
+    {
+        glyph->advance_x = advance / (float)(65536.0f*64.0f);
+    }
+    vector_push_back( self->glyphs, &glyph );
+
+    request.glyph = glyph;
+    request.result = *glyph;
+    request.buffer = NULL;
+    request.error = 0;
+    platform_mutex_lock( &self->queue->mutex );
+    self->queue->settings = *self;
+    vector_push_back( self->queue->requests, &request );
+    platform_cond_signal( &self->queue->cond );
+    platform_mutex_unlock( &self->queue->mutex );
+    return glyph;
+}
+
+
+// ---------------------------------------------- texture_font_request_compare ---
+int
+texture_font_request_compare( const void * a,
+                              const void * b )
+{
+    const texture_glyph_t *g1 = &((const texture_font_request_t *) a)->result;
+    const texture_glyph_t *g2 = &((const texture_font_request_t *) b)->result;
+
+    if( g1->height != g2->height )
+    {
+        return g2->height > g1->height ? 1 : -1;
+    }
+    return (g2->width > g1->width) - (g2->width < g1->width);
+}
+
+
+// -------------------------------------------- texture_font_update_glyphs ---
+size_t
+texture_font_update_glyphs( texture_font_t * self )
+{
+    size_t i, j, k, count = 0, kerning_count;
+    vector_t *ready;
+    vector_t *failed;
+    texture_font_request_t *request;
+    texture_glyph_t *glyph;
+    vector_t *swap;
+
+    assert( self );
+
+    if( !self->queue )
+    {
+        return 0;
+    }
+    ready = vector_new( sizeof(texture_font_request_t) );
+    platform_mutex_lock( &self->queue->mutex );
+    swap = self->queue->ready;
+    self->queue->ready = ready;
+    ready = swap;
+    self->render_count += self->queue->render_count;
+    self->queue->render_count = 0;
+    platform_mutex_unlock( &self->queue->mutex );
+
+    // Tallest glyphs first, as in texture_font_load_charset
+    qsort( ready->items, vector_size( ready ), sizeof(texture_font_request_t),
+           texture_font_request_compare );
+    failed = vector_new( sizeof(texture_glyph_t *) );
+    for( i=0; i<vector_size( ready ); ++i )
+    {
+        request = (texture_font_request_t *) vector_get( ready, i );
+        glyph = request->glyph;
+        if( !request->error )
+        {
+            glyph->width = request->result.width;
+            glyph->height = request->result.height;
+            glyph->offset_x = request->result.offset_x;
+            glyph->offset_y = request->result.offset_y;
+            glyph->advance_x = request->result.advance_x;
+            glyph->advance_y = request->result.advance_y;
+            if( texture_font_place_glyph( self, glyph, request->buffer ) )
+            {
+                glyph->pending = 0;
+                count++;
+            }
+        }
+        if( glyph->pending )
+        {
+            vector_push_back( failed, &glyph );
+        }
+        free( request->buffer );
+    }
+    vector_delete( ready );
+
+    // Glyphs that could not be rasterized or placed (atlas full) are
+    // dropped, such that they are requested again on next use (once
+    // eviction may have freed some space) instead of staying blank.
+    if( !vector_empty( failed ) )
+    {
+        kerning_count = self->kerning_count;
+        for( i=0, j=0; i<vector_size( self->glyphs ); ++i )
+        {
+            glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
+            for( k=0; k<vector_size( failed ); ++k )
+            {
+                if( *(texture_glyph_t **) vector_get( failed, k ) == glyph )
+                {
+                    break;
+                }
+            }
+            if( k == vector_size( failed ) )
+            {
+                vector_set( self->glyphs, j++, &glyph );
+                continue;
+            }
+            texture_glyph_delete( glyph );
+            if( i < self->kerning_count )
+            {
+                --kerning_count;
+            }
+        }
+        self->kerning_count = kerning_count;
+        vector_resize( self->glyphs, j );
+        self->glyph_table_count = (size_t)(-1);
+    }
+    vector_delete( failed );
+
+    if( count )
+    {
+        texture_atlas_upload( self->atlas );
+        texture_font_generate_kerning( self );
+    }
+    return count;
+}
+
+
 // ------------------------------------------------- texture_font_get_glyph ---
 texture_glyph_t *
 texture_font_get_glyph( texture_font_t * self,
                         wchar_t charcode )
 {
-    size_t i;
     wchar_t buffer[2] = {0,0};
     texture_glyph_t *glyph;
 
-    assert( self );
-
     assert( self );
     assert( self->filename );
     assert( self->atlas );
 
     /* Check if charcode has been already loaded */
-    for( i=0; i<self->glyphs->size; ++i )
+    // If charcode is -1, we don't care about outline type or thickness
+    if( charcode == (wchar_t)(-1) )
     {
-        glyph = *(texture_glyph_t **) vector_get( self->glyphs, i );
-        // If charcode is -1, we don't care about outline type or thickness
-        if( (glyph->charcode == charcode) &&
-            ((charcode == (wchar_t)(-1) ) || 
-             ((glyph->outline_type == self->outline_type) &&
-              (glyph->outline_thickness == self->outline_thickness)) ))
-        {
-            return glyph;
-        }
+        glyph = texture_font_find_glyph( self, charcode, 0, 0, 0 );
+    }
+    else
+    {
+        glyph = texture_font_find_glyph( self, charcode, self->outline_type,
+                                         self->outline_thickness,
+                                         texture_font_glyph_phase( self ) );
+    }
+    if( glyph )
+    {
+        glyph->last_used = ++self->atlas->clock;
+        return glyph;
+    }
+    // Fall back to synchronous loading if no thread could be started
+    if( self->async && (charcode != (wchar_t)(-1)) &&
+        (glyph = texture_font_request_glyph( self, charcode )) )
+    {
+        return glyph;
     }
 
     /* charcode -1 is special : it is used for line drawing (overline,
@@ -603,8 +2340,6 @@ texture_font_get_glyph( texture_font_t * self,
      */
     if( charcode == (wchar_t)(-1) )
     {
-        size_t width  = self->atlas->width;
-        size_t height = self->atlas->height;
         ivec4 region = texture_atlas_get_region( self->atlas, 5, 5 );
         texture_glyph_t * glyph = texture_glyph_new( );
         static unsigned char data[4*4*3] = {-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
@@ -618,10 +2353,8 @@ texture_font_get_glyph( texture_font_t * self,
         }
         texture_atlas_set_region( self->atlas, region.x, region.y, 4, 4, data, 0 );
         glyph->charcode = (wchar_t)(-1);
-        glyph->s0 = (region.x+2)/(float)width;
-        glyph->t0 = (region.y+2)/(float)height;
-        glyph->s1 = (region.x+3)/(float)width;
-        glyph->t1 = (region.y+3)/(float)height;
+        glyph->last_used = ++self->atlas->clock;
+        texture_font_set_glyph_region( self, glyph, region );
         vector_push_back( self->glyphs, &glyph );
         return glyph; //*(texture_glyph_t **) vector_back( self->glyphs );
     }
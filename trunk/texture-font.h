@@ -35,6 +35,10 @@
 #define __TEXTURE_FONT_H__
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include FT_STROKER_H
 
 #ifdef __cplusplus
 extern "C" {
@@ -42,6 +46,7 @@ extern "C" {
 
 #include "vector.h"
 #include "texture-atlas.h"
+#include "font-registry.h"
 
 /**
  * @file   texture-font.h
@@ -67,24 +72,169 @@ extern "C" {
 
 
 /**
- * A structure that hold a kerning value relatively to a charcode.
- *
- * This structure cannot be used alone since the (necessary) right charcode is
- * implicitely held by the owner of this structure.
+ * Kerning values are stored in 1/KERNING_SCALE pixels (16 bits, that is
+ * up to 128 pixels either way).
+ */
+#define KERNING_SCALE 256
+
+
+/**
+ * Slot value of the pairs whose kerning does not fit in 16 bits, the value
+ * is kept aside with the pairs out of the basic multilingual plane.
+ */
+#define KERNING_WIDE (-32768)
+
+
+/**
+ * A structure that hold the kerning value of a pair of charcodes of the
+ * basic multilingual plane.
  */
 typedef struct
 {
     /**
      * Left character code in the kern pair.
      */
-    wchar_t charcode;
-    
+    uint16_t left;
+
+    /**
+     * Right character code in the kern pair.
+     */
+    uint16_t right;
+
+    /**
+     * Kerning value (in 1/KERNING_SCALE pixels, never 0 for a used entry,
+     * KERNING_WIDE if the value is kept aside).
+     */
+    int16_t kerning;
+
+} kerning_pair_t;
+
+
+
+/**
+ * A structure that hold the kerning value of a pair of charcodes out of
+ * the basic multilingual plane, or of a pair whose kerning is too large
+ * for a kerning_pair_t.
+ */
+typedef struct
+{
+    /**
+     * Left character code in the kern pair.
+     */
+    wchar_t left;
+
+    /**
+     * Right character code in the kern pair.
+     */
+    wchar_t right;
+
     /**
      * Kerning value (in fractional pixels).
      */
     float kerning;
 
-} kerning_t;
+} kerning_wide_pair_t;
+
+
+
+/**
+ * Kerning pairs of a font, stored in an open addressing hash table (linear
+ * probing) keyed on the (left, right) charcodes. Only non null kerning values
+ * are stored, such that empty slots are the ones with a null kerning. Most
+ * lookups find no pair: a Bloom filter (two bits per pair, 8 bits per slot)
+ * answers them without visiting the table in most cases. The rare pairs
+ * involving charcodes out of the basic multilingual plane, or whose kerning
+ * does not fit in 16 bits (large or high resolution fonts), are kept aside.
+ */
+typedef struct
+{
+    /**
+     * Table slots.
+     */
+    kerning_pair_t * pairs;
+
+    /**
+     * Bloom filter of the stored pairs (capacity bytes).
+     */
+    unsigned char * filter;
+
+    /**
+     * Pairs (kerning_wide_pair_t) kept aside, either out of the basic
+     * multilingual plane or with a kerning out of the 16 bits range.
+     */
+    vector_t * wide;
+
+    /**
+     * Number of slots (always a power of two).
+     */
+    size_t capacity;
+
+    /**
+     * Number of stored kerning pairs (wide ones included).
+     */
+    size_t count;
+
+    /**
+     * Number of used slots.
+     */
+    size_t used;
+
+    /**
+     * Number of lookups performed so far.
+     */
+    size_t lookups;
+
+    /**
+     * Number of slots visited by those lookups.
+     */
+    size_t probes;
+
+    /**
+     * Number of lookups answered by the filter alone.
+     */
+    size_t filtered;
+
+} kerning_table_t;
+
+
+
+/**
+ * Kerning table statistics (see texture_font_get_kerning_stats).
+ */
+typedef struct
+{
+    /**
+     * Number of kerning pairs.
+     */
+    size_t pairs;
+
+    /**
+     * Memory used by the kerning table (in bytes).
+     */
+    size_t memory;
+
+    /**
+     * Memory the same pairs took as per-glyph vectors of (charcode,
+     * kerning), the layout used before the kerning table (in bytes).
+     */
+    size_t vectors_memory;
+
+    /**
+     * Number of kerning lookups.
+     */
+    size_t lookups;
+
+    /**
+     * Average number of slots visited per lookup.
+     */
+    float probes;
+
+    /**
+     * Fraction of the lookups answered by the filter alone.
+     */
+    float filtered;
+
+} kerning_stats_t;
 
 
 
@@ -137,6 +287,11 @@ typedef struct
      */
     unsigned int id;
 
+    /**
+     * Glyph index in the font face (cached to avoid charmap lookups)
+     */
+    unsigned int glyph_index;
+
     /**
      * Glyph's width in pixels.
      */
@@ -195,9 +350,25 @@ typedef struct
     float t1;
 
     /**
-     * A vector of kerning pairs relative to this glyph.
+     * Atlas page (texture array layer) holding the glyph
+     */
+    size_t page;
+
+    /**
+     * Value of the atlas clock when the glyph was last requested
+     */
+    size_t last_used;
+
+    /**
+     * Whether glyph is still being rasterized (see texture_font_t.async).
+     * Until then, it has no bitmap and only its advance is known.
      */
-    vector_t * kerning;
+    int pending;
+
+    /**
+     * Kerning table of the font this glyph belongs to.
+     */
+    kerning_table_t * kerning_table;
 
     /**
      * Glyph outline type (0 = None, 1 = line, 2 = inner, 3 = outer)
@@ -209,10 +380,35 @@ typedef struct
      */
     float outline_thickness;
 
+    /**
+     * Horizontal subpixel phase the glyph is rasterized at, in
+     * 1/texture_font_t.subpixel_phases of pixel (0 for whole pixels)
+     */
+    int phase;
+
 } texture_glyph_t;
 
 
 
+/**
+ * Glyph rendering modes (see texture_font_t.render_mode)
+ */
+/** Anti-aliased (or LCD subpixel) bitmaps (default) */
+#define TEXTURE_FONT_BITMAP         0
+/** Signed distance fields for the distance-field shaders, which can be
+ *  drawn at any scale (atlas depth must be 1) */
+#define TEXTURE_FONT_DISTANCE_FIELD 1
+/** Multi-channel signed distance fields computed from glyph outlines,
+ *  keeping corners sharp at any scale (atlas depth must be 3) */
+#define TEXTURE_FONT_MULTI_DISTANCE_FIELD 2
+
+
+/**
+ * Background rasterization state of a font (see texture_font_t.async)
+ */
+typedef struct texture_font_queue_t texture_font_queue_t;
+
+
 /**
  *  Texture font structure.
  */
@@ -223,6 +419,24 @@ typedef struct
      */
     vector_t * glyphs;
 
+    /**
+     * Open addressing hash table (linear probing) indexing the glyphs vector
+     * on (charcode, outline type, outline thickness). Empty slots are NULL.
+     */
+    texture_glyph_t ** glyph_table;
+
+    /**
+     * Number of slots of the glyph table (always a power of two).
+     */
+    size_t glyph_table_capacity;
+
+    /**
+     * Number of glyphs (from the start of the glyphs vector) indexed in the
+     * glyph table. Glyphs pushed directly into the vector are indexed on the
+     * next lookup.
+     */
+    size_t glyph_table_count;
+
     /**
      * Atlas structure to store glyphs data.
      */
@@ -233,6 +447,41 @@ typedef struct
      */
     char * filename;
 
+    /**
+     * Font file content, shared with other fonts using the same file. Faces
+     * are created from it instead of reading the file again.
+     */
+    font_file_t * file;
+
+    /**
+     * Freetype library handle (possibly shared with other fonts)
+     */
+    FT_Library library;
+
+    /**
+     * Whether the library handle has been got by texture_font_new from the
+     * font registry (and has to be released with the font)
+     */
+    int library_owner;
+
+    /**
+     * Freetype face, shared with the other fonts of the same file and
+     * library and kept until the font is deleted. It is NULL if the font
+     * file could not be opened.
+     */
+    FT_Face face;
+
+    /**
+     * Font registry entry of the face
+     */
+    font_face_t * shared;
+
+    /**
+     * Size object of this font in the shared face, activated before the
+     * face is used
+     */
+    FT_Size size_object;
+
     /**
      * Font size
      */
@@ -253,6 +502,44 @@ typedef struct
      */
     float outline_thickness;
 
+    /**
+     * How glyphs are rendered: TEXTURE_FONT_BITMAP (default),
+     * TEXTURE_FONT_DISTANCE_FIELD or TEXTURE_FONT_MULTI_DISTANCE_FIELD. To
+     * be set before loading glyphs.
+     */
+    int render_mode;
+
+    /**
+     * Number of horizontal subpixel phases glyphs may be rasterized at
+     * (0 or 1 when glyphs are only rasterized at whole pixels). Each phase
+     * is a distinct glyph, shifted right by phase/subpixel_phases pixel.
+     */
+    size_t subpixel_phases;
+
+    /**
+     * Phase of the glyphs looked up or loaded (0 by default), to be set
+     * back to 0 after use
+     */
+    int phase;
+
+    /**
+     * Pixels added around distance field glyphs, which is also the largest
+     * distance encoded (4 by default)
+     */
+    size_t padding;
+
+    /**
+     * Distance transform of distance field glyphs: DISTANCE_FIELD_EDTAA3
+     * (default) or DISTANCE_FIELD_EXACT (see distance-field.h)
+     */
+    int distance_engine;
+
+    /**
+     * Stroker of outlined glyphs, created on first need and kept for the
+     * next ones (whatever their outline type and thickness).
+     */
+    FT_Stroker stroker;
+
     /** 
      * Whether to use our own lcd filter.
      */
@@ -263,11 +550,68 @@ typedef struct
      */
     int kerning;
 
+    /**
+     * Kerning pairs of the glyphs contained in this font.
+     */
+    kerning_table_t * kerning_table;
+
+    /**
+     * Number of glyphs (from the start of the glyphs vector) whose kerning
+     * pairs have already been generated.
+     */
+    size_t kerning_count;
+
     /**
      * LCD filter weights
      */
     unsigned char lcd_weights[5];
 
+    /**
+     * Number of freetype render calls (glyph loads with rendering and
+     * glyph to bitmap conversions) made while loading glyphs.
+     */
+    size_t render_count;
+
+    /**
+     * Number of threads rasterizing glyphs in texture_font_load_charset
+     * (1 by default). The calling thread is one of them.
+     */
+    size_t threads;
+
+    /**
+     * Freetype libraries and faces of the other rasterization threads
+     * (faces can't be shared between threads), created on first need.
+     */
+    FT_Library * worker_libraries;
+
+    /**
+     * Faces of the other rasterization threads (see worker_libraries)
+     */
+    FT_Face * worker_faces;
+
+    /**
+     * Strokers of the other rasterization threads (NULL until needed)
+     */
+    FT_Stroker * worker_strokers;
+
+    /**
+     * Number of worker libraries and faces
+     */
+    size_t worker_count;
+
+    /**
+     * Whether glyphs missing in texture_font_get_glyph are rasterized in
+     * background (0 by default). A pending glyph is returned right away and
+     * texture_font_update_glyphs must be called (e.g. once per frame) to
+     * get it into the atlas.
+     */
+    int async;
+
+    /**
+     * Glyphs waiting to be rasterized or committed (async mode)
+     */
+    texture_font_queue_t * queue;
+
     /**
      * This field is simply used to compute a default line spacing (i.e., the
      * baseline-to-baseline distance) when writing text with this font. Note
@@ -326,7 +670,8 @@ typedef struct
  * texture atlas is used to store glyph on demand. Note the depth of the atlas
  * will determine if the font is rendered as alpha channel only (depth = 1) or
  * RGB (depth = 3) that correspond to subpixel rendering (if available on your
- * freetype implementation).
+ * freetype implementation). Fonts created this way share a freetype library,
+ * hence a single face per font file.
  *
  * @param atlas     A texture atlas
  * @param filename  A font filename
@@ -341,6 +686,44 @@ typedef struct
                     const float size );
 
 
+/**
+ * This function creates a texture font with default settings and no face:
+ * glyphs and metrics are filled by the caller (see font_cache_load).
+ *
+ * @param atlas     A texture atlas
+ * @param filename  Filename of the font the glyphs come from
+ * @param size      Size of the font (in points)
+ *
+ * @return A new empty font (no glyph inside yet)
+ *
+ */
+  texture_font_t *
+  texture_font_alloc( texture_atlas_t * atlas,
+                      const char * filename,
+                      const float size );
+
+
+/**
+ * This function creates a new texture font from given filename and size using
+ * an existing freetype library handle. The library is not owned by the font
+ * and must outlive it, which allows several fonts (e.g. the ones of a font
+ * manager) to share a single handle and a single face per font file.
+ *
+ * @param atlas     A texture atlas
+ * @param library   A valid freetype library handle
+ * @param filename  A font filename
+ * @param size      Size of font to be created (in points)
+ *
+ * @return A new empty font (no glyph inside yet)
+ *
+ */
+  texture_font_t *
+  texture_font_new_with_library( texture_atlas_t * atlas,
+                                 FT_Library library,
+                                 const char * filename,
+                                 const float size );
+
+
 /**
  * Delete a texture font. Note that this does not delete the glyph from the
  * texture atlas.
@@ -353,7 +736,8 @@ typedef struct
 
 /**
  * Request a new glyph from the font. If it has not been created yet, it will
- * be. 
+ * be. In async mode, a new glyph is returned pending (with its advance only)
+ * and is rasterized in background (see texture_font_update_glyphs).
  *
  * @param self     A valid texture font
  * @param charcode Character codepoint to be loaded.
@@ -367,6 +751,22 @@ typedef struct
                           wchar_t charcode );
 
 
+/**
+ * Commit glyphs rasterized in background (async mode) into the atlas. The
+ * texture is uploaded and kerning generated once for all of them. Text
+ * using glyphs that were pending must be laid out again when this returns
+ * a non zero value. Glyphs that could not be rasterized or placed (atlas
+ * full) are deleted and requested again on their next use, such that
+ * pointers to pending glyphs must not be kept across this call.
+ *
+ * @param self a valid texture font
+ *
+ * @return Number of glyphs that are no longer pending
+ */
+  size_t
+  texture_font_update_glyphs( texture_font_t * self );
+
+
 /**
  * Request the loading of several glyphs at once.
  *
@@ -380,6 +780,65 @@ typedef struct
   texture_font_load_glyphs( texture_font_t * self,
                             const wchar_t * charcodes );
 
+/**
+ * Request the loading of a whole charset at once. Glyphs are rasterized
+ * first (by self->threads threads) and then packed from the tallest to the
+ * shortest, which uses the atlas much better than loading them in string
+ * order. Texture is uploaded and kerning generated once.
+ *
+ * @param self      a valid texture font
+ * @param charcodes character codepoints to be loaded.
+ *
+ * @return Number of missed glyph if the texture is not big enough to hold
+ *         every glyphs.
+ */
+  size_t
+  texture_font_load_charset( texture_font_t * self,
+                             const wchar_t * charcodes );
+
+
+/**
+ * Remove glyphs that have not been requested since a given atlas clock
+ * value, freeing their atlas regions. The special glyph -1 and pending glyphs
+ * are always kept.
+ * Texture coordinates of removed glyphs may be reused by new glyphs.
+ *
+ * @param self   a valid texture font
+ * @param before atlas clock value glyphs must have been requested since
+ *
+ * @return Number of removed glyphs
+ */
+  size_t
+  texture_font_remove_glyphs( texture_font_t * self,
+                              const size_t before );
+
+
+/**
+ * Get the atlas region (including separation pixels) allocated for a glyph.
+ *
+ * @param self  a valid texture font
+ * @param glyph a glyph of the font
+ *
+ * @return Atlas region of the glyph (y includes the page offset)
+ */
+  ivec4
+  texture_font_get_glyph_region( const texture_font_t * self,
+                                 const texture_glyph_t * glyph );
+
+
+/**
+ * Set glyph page and texture coordinates from an atlas region.
+ *
+ * @param self   a valid texture font
+ * @param glyph  a glyph of the font
+ * @param region Atlas region of the glyph (y includes the page offset)
+ */
+  void
+  texture_font_set_glyph_region( const texture_font_t * self,
+                                 texture_glyph_t * glyph,
+                                 const ivec4 region );
+
+
 /**
  * Get the kerning between two horizontal glyphs.
  *
@@ -393,6 +852,82 @@ texture_glyph_get_kerning( const texture_glyph_t * self,
                            const wchar_t charcode );
 
 
+/**
+ * Get the kerning between two horizontal charcodes.
+ *
+ * @param self      a valid texture font
+ * @param left      codepoint of the left glyph
+ * @param right     codepoint of the right glyph
+ *
+ * @return x kerning value
+ */
+float
+texture_font_get_kerning( texture_font_t * self,
+                          const wchar_t left,
+                          const wchar_t right );
+
+
+/**
+ * Get statistics about the kerning table of a font.
+ *
+ * @param self      a valid texture font
+ * @param stats     structure to be filled
+ */
+void
+texture_font_get_kerning_stats( const texture_font_t * self,
+                                kerning_stats_t * stats );
+
+
+/**
+ * Create an empty kerning table.
+ *
+ * @param capacity initial number of slots (a power of two)
+ *
+ * @return a new kerning table
+ */
+kerning_table_t *
+kerning_table_new( size_t capacity );
+
+
+/**
+ * Delete a kerning table.
+ *
+ * @param self a valid kerning table
+ */
+void
+kerning_table_delete( kerning_table_t * self );
+
+
+/**
+ * Set the kerning of a pair of charcodes.
+ *
+ * @param self    a valid kerning table
+ * @param left    left character code
+ * @param right   right character code
+ * @param kerning kerning value (non null)
+ */
+void
+kerning_table_set( kerning_table_t * self,
+                   const wchar_t left,
+                   const wchar_t right,
+                   const float kerning );
+
+
+/**
+ * Get the kerning of a pair of charcodes.
+ *
+ * @param self  a valid kerning table
+ * @param left  left character code
+ * @param right right character code
+ *
+ * @return kerning value (0 if the pair is not in the table)
+ */
+float
+kerning_table_get( kerning_table_t * self,
+                   const wchar_t left,
+                   const wchar_t right );
+
+
 /**
  * Creates a new empty glyph
  *